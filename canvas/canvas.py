@@ -11,6 +11,7 @@ from __future__ import print_function
 
 import os
 import socket
+import struct
 import sys
 import tempfile
 
@@ -38,21 +39,31 @@ def get_config():
         print("MONITOR PORT not defined in config.inc")
         sys.exit()
 
+# Packed binary position file, see src/airline/PosFile.h
+POSFILE_MAGIC = 0x53504657
+POSFILE_HDR = struct.Struct('<IHHII')
+POSFILE_REC = struct.Struct('<Iddd')
+
+
 def query_nodes():
-    fd, path = tempfile.mkstemp(text=True)
+    fd, path = tempfile.mkstemp()
     cmd_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
     cmd_sock.settimeout(1)
-    cmd_sock.sendto(('AL:cmd_node_position:%s' % path).encode(), ('localhost', MONITOR_PORT))
-    if 'SUCCESS' != cmd_sock.recv(32).decode().strip('\0'):
+    cmd_sock.sendto(('AL:cmd_get_positions:%s' % path).encode(), ('localhost', MONITOR_PORT))
+    if not cmd_sock.recv(64).decode().strip('\0').startswith('SUCCESS'):
         os.remove(path)
         return
     cmd_sock.close()
     nodes = []
-    with os.fdopen(fd) as outfile:
-        for line in outfile:
-            _, node_id, _, x, y, _ = line.split()
-            nodes.append({'data': {'id': node_id}, 'position': {'x': float(x), 'y': float(y)}})
+    with os.fdopen(fd, 'rb') as outfile:
+        data = outfile.read()
     os.remove(path)
+    magic, _, rec_sz, count, _ = POSFILE_HDR.unpack_from(data)
+    if magic != POSFILE_MAGIC or rec_sz != POSFILE_REC.size:
+        return
+    for i in range(count):
+        node_id, x, y, _ = POSFILE_REC.unpack_from(data, POSFILE_HDR.size + i * rec_sz)
+        nodes.append({'data': {'id': str(node_id)}, 'position': {'x': x, 'y': y}})
     return nodes
 
 
@@ -0,0 +1,230 @@
+#!/bin/bash
+
+# Scaling benchmark: sweeps numOfNodes over grid/randrect topologies with a
+# fixed wf_trafgen traffic profile and records airline cpu, memory, startup
+# time, realtime drift, commline throughput and delivery into a JSON report.
+# The report is compared against a stored baseline with thresholds.
+
+usage()
+{
+	cat <<EOF
+Usage: $0 [-n "<nodes>..."] [-t "<topology>..."] [-d <sec>] [-o <report>] [-b <baseline>] [-u]
+  -n  node counts to sweep, default "$PERF_NODES"
+  -t  topologies to sweep, default "$PERF_TOPOS"
+  -d  measurement window per run in sec, default $PERF_DURATION
+  -o  report file, default $PERF_REPORT
+  -b  baseline to compare against, default $PERF_BASELINE
+  -u  store the report as the new baseline instead of comparing, needed
+      once per host since a missing baseline fails the run
+Env: PERF_TRAFFIC=<wf_trafgen TG_ tokens>, PERF_SPACING=<m>, PERF_WARMUP=<sec>,
+     PERF_START_TIMEOUT=<sec>
+EOF
+	exit 1
+}
+
+PERF_DIR=`dirname "$0"`
+PERF_DIR=`readlink -f "$PERF_DIR"`
+WF_DIR=`readlink -f "$PERF_DIR/../.."`
+DIR="$WF_DIR/scripts"
+. $DIR/helpers.sh
+
+PERF_NODES=${PERF_NODES:-"10 100 1000"}
+PERF_TOPOS=${PERF_TOPOS:-"grid randrect"}
+PERF_DURATION=${PERF_DURATION:-30}
+PERF_WARMUP=${PERF_WARMUP:-5}
+PERF_START_TIMEOUT=${PERF_START_TIMEOUT:-600}
+PERF_SPACING=${PERF_SPACING:-40}
+PERF_TRAFFIC=${PERF_TRAFFIC:-"TG_RATE=1 TG_ARRIVAL=poisson TG_BCAST=0.1 TG_SIZE=50 TG_DST=nbr"}
+PERF_REPORT=${PERF_REPORT:-log/perf/report.json}
+PERF_BASELINE=${PERF_BASELINE:-$PERF_DIR/baseline.json}
+PERF_THRESHOLDS=$PERF_DIR/thresholds.json
+RUN_DIR=log/perf
+
+while getopts "n:t:d:o:b:uh" o; do
+	case "$o" in
+		n) PERF_NODES="$OPTARG" ;;
+		t) PERF_TOPOS="$OPTARG" ;;
+		d) PERF_DURATION="$OPTARG" ;;
+		o) PERF_REPORT="$OPTARG" ;;
+		b) PERF_BASELINE="$OPTARG" ;;
+		u) update_baseline=1 ;;
+		*) usage ;;
+	esac
+done
+
+[[ "`whereis jq | cut -d ':' -f 2`" == "" ]] && echo "jq cmd not found. Install jq (JSON parser)." && exit 1
+cd $WF_DIR
+[[ ! -x "$BINDIR/wf_trafgen" ]] && echo "$BINDIR/wf_trafgen not found, build whitefield first" && exit 1
+mkdir -p $RUN_DIR
+
+now_ms()
+{
+	date +%s%3N
+}
+
+# utime+stime of the airline process in clock ticks
+cpu_ticks()
+{
+	awk '{ print $14 + $15 }' /proc/$1/stat 2>/dev/null
+}
+
+proc_kb()
+{
+	awk -v key="$2:" '$1 == key { print $2 }' /proc/$1/status 2>/dev/null
+}
+
+sim_drift()
+{
+	al_cmd cmd_sim_time | jq -r .drift_ms 2>/dev/null
+}
+
+# frames between the airline and all the stacklines so far
+cl_frames()
+{
+	al_cmd cmd_mac_stats | sed -n 's/^\(MCAST\|UCAST\)_PKTS: rx=\([0-9]*\),tx=\([0-9]*\).*/\2 \3/p' |
+		awk '{ n += $1 + $2 } END { print n + 0 }'
+}
+
+gen_cfg()
+{
+	local topo=$1 nodes=$2 cfg=$3 gw
+	gw=`awk -v n=$nodes 'BEGIN { w = int(sqrt(n)); if (w * w < n) w++; print w }'`
+	cat > $cfg <<EOF
+include=regression/perf/perf.cfg
+numOfNodes=$nodes
+topologyType=$topo
+gridWidth=$gw
+fieldX=$((gw * PERF_SPACING))
+fieldY=$((gw * PERF_SPACING))
+nodeExec=$BINDIR/wf_trafgen \$NODEID $PERF_TRAFFIC TG_STATS=$4
+EOF
+}
+
+wait_ready()
+{
+	local nodes=$1 start=`now_ms` st
+	while [ $(((`now_ms` - start) / 1000)) -lt $PERF_START_TIMEOUT ]; do
+		st=`fk_cmd cmd_node_status | head -1`
+		if [[ "$st" == "nodes=$nodes running=$nodes "* ]] && [ "`sim_drift`" != "" ]; then
+			return 0
+		fi
+		sleep 0.5
+	done
+	return 1
+}
+
+wait_trafgen_exit()
+{
+	for((i=0;i<60;i++)); do
+		pgrep -u `whoami` -x wf_trafgen >/dev/null || return 0
+		sleep 0.5
+	done
+}
+
+# Merges the per node wf_trafgen stats lines into delivery and latency
+trafgen_summary()
+{
+	jq -s '
+	def pct($h; $p): ($h | map(.[1]) | add) as $n |
+		if $n == null then 0 else
+		[foreach $h[] as $b (0; . + $b[1]; [$b[0], .])] | map(select(.[1] > $n * $p)) | .[0][0]
+		end;
+	(map(.lat_us.hist[]) | group_by(.[0]) | map([.[0][0], (map(.[1]) | add)])) as $lat |
+	(map(.ack_us.hist[]) | group_by(.[0]) | map([.[0][0], (map(.[1]) | add)])) as $ack |
+	{
+		stacklines: length,
+		tx_ucast: (map(.tx_ucast) | add),
+		tx_bcast: (map(.tx_bcast) | add),
+		blocked: (map(.blocked) | add),
+		ucast_delivery: ((map(.ack_ok) | add) / ([(map(.tx_ucast) | add), 1] | max)),
+		bcast_rx_per_tx: ((map(.rx_bcast) | add) / ([(map(.tx_bcast) | add), 1] | max)),
+		lat_p50_us: pct($lat; 0.5), lat_p99_us: pct($lat; 0.99),
+		ack_p50_us: pct($ack; 0.5), ack_p99_us: pct($ack; 0.99)
+	}' $1
+}
+
+run_one()
+{
+	local topo=$1 nodes=$2 tag="$1_$2"
+	local cfg=$RUN_DIR/$tag.cfg tgstats=$RUN_DIR/$tag.trafgen.json
+	local t0 t_ready wfpid c0 c1 f0 f1 d0 d1 t1 t2 rss hwm tg
+
+	echo "[$tag] starting..."
+	rm -f $tgstats
+	gen_cfg $topo $nodes $cfg $tgstats
+	stop_whitefield >/dev/null
+	t0=`now_ms`
+	./invoke_whitefield.sh $cfg >/dev/null
+	if ! wait_ready $nodes; then
+		echo "[$tag] not up in $PERF_START_TIMEOUT sec"
+		stop_whitefield >/dev/null
+		echo "{\"topology\":\"$topo\",\"nodes\":$nodes,\"error\":\"startup timeout\"}" >> $RUN_DIR/runs.json
+		return 1
+	fi
+	t_ready=`now_ms`
+	wfpid=`wf_get_pid`
+	sleep $PERF_WARMUP
+
+	t1=`now_ms`; c0=`cpu_ticks $wfpid`; f0=`cl_frames`; d0=`sim_drift`
+	sleep $PERF_DURATION
+	t2=`now_ms`; c1=`cpu_ticks $wfpid`; f1=`cl_frames`; d1=`sim_drift`
+	rss=`proc_kb $wfpid VmRSS`; hwm=`proc_kb $wfpid VmHWM`
+
+	stop_whitefield >/dev/null
+	wait_trafgen_exit
+	tg=`trafgen_summary $tgstats 2>/dev/null`
+	[[ "$tg" == "" ]] && tg="{}"
+	jq -n -c --arg topo $topo --argjson nodes $nodes \
+		--argjson startup $(((t_ready - t0))) --argjson win $((t2 - t1)) \
+		--argjson c0 ${c0:-0} --argjson c1 ${c1:-0} --argjson hz `getconf CLK_TCK` \
+		--argjson f0 ${f0:-0} --argjson f1 ${f1:-0} \
+		--argjson d0 ${d0:-0} --argjson d1 ${d1:-0} \
+		--argjson rss ${rss:-0} --argjson hwm ${hwm:-0} --argjson tg "$tg" '{
+		topology: $topo, nodes: $nodes,
+		startup_s: ($startup / 1000),
+		cpu_pct: (($c1 - $c0) * 100 / $hz / ($win / 1000)),
+		rss_kb: $rss, rss_peak_kb: $hwm,
+		drift_ms: $d1, drift_ms_per_s: (($d1 - $d0) / ($win / 1000)),
+		commline_msgs_per_sec: (($f1 - $f0) / ($win / 1000))
+	} + $tg' | tee -a $RUN_DIR/runs.json
+}
+
+# Regressed metrics of the report vs the baseline, one line each
+compare()
+{
+	jq -r -n --slurpfile rep $1 --slurpfile base $2 --slurpfile thr $PERF_THRESHOLDS '
+	$rep[0].runs[] as $r |
+	($base[0].runs[] | select(.topology == $r.topology and .nodes == $r.nodes)) as $b |
+	$thr[0] | to_entries[] | .key as $k | .value as $t |
+	select($r[$k] != null and $b[$k] != null) |
+	(if $t.worse == "higher" then $r[$k] - $b[$k] else $b[$k] - $r[$k] end) as $d |
+	select($d > ($t.rel * ($b[$k] | fabs)) and $d > $t.abs) |
+	"\($r.topology)/\($r.nodes) \($k): \($b[$k]) -> \($r[$k])"'
+}
+
+rm -f $RUN_DIR/runs.json
+for topo in $PERF_TOPOS; do
+	for nodes in $PERF_NODES; do
+		run_one $topo $nodes
+	done
+done
+mkdir -p `dirname $PERF_REPORT`
+jq -s --arg host "`hostname`" --arg cpus "`nproc`" --arg rev "`git rev-parse --short HEAD 2>/dev/null`" \
+	--arg date "`date -Iseconds`" --arg traffic "$PERF_TRAFFIC" \
+	'{ host: $host, cpus: ($cpus | tonumber), rev: $rev, date: $date, traffic: $traffic, runs: . }' \
+	$RUN_DIR/runs.json > $PERF_REPORT
+echo "report: $PERF_REPORT"
+
+if [ "$update_baseline" == "1" ]; then
+	cp $PERF_REPORT $PERF_BASELINE
+	echo "baseline updated: $PERF_BASELINE"
+	exit 0
+fi
+[[ ! -f "$PERF_BASELINE" ]] && echo "no baseline $PERF_BASELINE, run with -u to store one" && exit 1
+[[ "`jq -r .host $PERF_BASELINE`" != "`hostname`" ]] && echo "warning: baseline is from host `jq -r .host $PERF_BASELINE`"
+errs=`jq -r '.runs[] | select(.error) | "\(.topology)/\(.nodes) \(.error)"' $PERF_REPORT`
+regs=`compare $PERF_REPORT $PERF_BASELINE`
+[[ "$errs" == "" ]] && [[ "$regs" == "" ]] && echo "no performance regression" && exit 0
+echo "performance regression:"
+printf "%s\n%s\n" "$errs" "$regs" | sed '/^$/d'
+exit 1
@@ -37,13 +37,19 @@ sl_cmd()
 	$UDP_TOOL localhost $MONITOR_PORT "SL:$1"
 }
 
+fk_cmd()
+{
+	$UDP_TOOL localhost $MONITOR_PORT "FK:$1"
+}
+
 get_node_list()
 {
 	usr=`whoami`
 	readarray nodelist < <(ps -h --ppid `pgrep -u $usr -x $FORKER_PNAME` -o "%p %a" | grep -v "defunct")
-	readarray dead_nodelist < <(ps -h --ppid `pgrep -u $usr -x $FORKER_PNAME` -o "%p %a" | grep "defunct")
 	nodecnt=${#nodelist[@]}
-	dead_nodecnt=${#dead_nodelist[@]}
+	# exited stacklines are reaped by the forker, so ask it for the count
+	dead_nodecnt=`fk_cmd "cmd_node_status" | head -1 | sed -n 's/.*exited=\([0-9]*\).*/\1/p'`
+	dead_nodecnt=${dead_nodecnt:-0}
 }
 
 get_node_range()
@@ -157,9 +163,12 @@ path_downstream()
 native_shell()
 {
     [[ "$1" == "" ]] && echo "Usage: native_shell <nodeid>" && return
-    udspath=`printf "log/%04x.uds" $1`
-    echo -en "connecting to [$udspath]..."
-    echo "" | socat UNIX:$udspath -
-    [[ $? -ne 0 ]] && return
-    socat UNIX:$udspath -
+    udspath=`printf "${LOGPATH:-log}/%04x.uds" $1`
+    [[ ! -S $udspath ]] && echo "no console at [$udspath], node not running with PTY=1?" && return 1
+    if [ -t 0 ]; then
+        echo "connecting to [$udspath], detach with Ctrl-]..."
+        socat -,raw,echo=0,escape=0x1d UNIX-CONNECT:$udspath
+    else
+        socat - UNIX-CONNECT:$udspath
+    fi
 }
@@ -0,0 +1,90 @@
+#!/usr/bin/env python
+#
+# Plays back a node position trace using the bulk cmd_set_positions command.
+# All the node moves for a given timestamp are applied in one shot.
+#
+# Trace format (CSV, sorted by time): <time_sec>,<nodeid>,<x>,<y>[,<z>]
+#
+# This file is part of Whitefield, published under the terms of the GNU General Public License version 2.
+# See the LICENSE file in the top level  directory for more details.
+
+from __future__ import print_function
+
+import os
+import socket
+import struct
+import sys
+import tempfile
+import time
+
+# Packed binary position file, see src/airline/PosFile.h
+POSFILE_MAGIC = 0x53504657
+POSFILE_HDR = struct.Struct('<IHHII')
+POSFILE_REC = struct.Struct('<Iddd')
+
+
+def get_monitor_port():
+    with open(os.path.join(os.path.dirname(__file__), '..', 'config.inc')) as cfg:
+        for line in cfg:
+            name, var = line.partition("=")[::2]
+            if name.strip() == 'MONITOR_PORT':
+                return int(var.strip())
+    print("MONITOR_PORT not defined in config.inc")
+    sys.exit(1)
+
+
+def read_trace(fname):
+    steps = []
+    with open(fname) as trace:
+        for line in trace:
+            line = line.split('#')[0].strip()
+            if not line:
+                continue
+            f = line.split(',')
+            ts = float(f[0])
+            rec = (int(f[1]), float(f[2]), float(f[3]), float(f[4]) if len(f) > 4 else 0.0)
+            if not steps or steps[-1][0] != ts:
+                steps.append((ts, []))
+            steps[-1][1].append(rec)
+    return steps
+
+
+def set_positions(sock, port, path, recs):
+    with open(path, 'wb') as posf:
+        posf.write(POSFILE_HDR.pack(POSFILE_MAGIC, 1, POSFILE_REC.size, len(recs), 0))
+        for r in recs:
+            posf.write(POSFILE_REC.pack(*r))
+    sock.sendto(('AL:cmd_set_positions:%s' % path).encode(), ('localhost', port))
+    rsp = sock.recv(128).decode().strip('\0')
+    sock.recv(16)  # END
+    return rsp
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: %s <trace.csv>" % sys.argv[0])
+        sys.exit(1)
+    port = get_monitor_port()
+    steps = read_trace(sys.argv[1])
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(2)
+    fd, path = tempfile.mkstemp()
+    os.close(fd)
+    start = time.time()
+    try:
+        for ts, recs in steps:
+            delay = start + ts - time.time()
+            if delay > 0:
+                time.sleep(delay)
+            rsp = set_positions(sock, port, path, recs)
+            if not rsp.startswith('SUCCESS'):
+                print('t=%.3f set positions failed: %s' % (ts, rsp), file=sys.stderr)
+                break
+    except socket.timeout:
+        print('No response received from AirLine. Is Whitefield running?', file=sys.stderr)
+    finally:
+        os.remove(path)
+
+
+if __name__ == '__main__':
+    main()
@@ -8,6 +8,14 @@ DAOACK_CODE=0x03
 MCAST16_ADDR=0xffff
 JSON_OUT="stats.json"
 
+# Prefer the native single-pass analyzer (src/utils/pcap_stats.cc) if built
+DIR=`dirname $0`
+[[ -f "$DIR/../config.inc" ]] && . $DIR/../config.inc
+BINDIR=${BINDIR:-bin}
+[[ "${BINDIR:0:1}" != "/" ]] && BINDIR="$DIR/../$BINDIR"
+NATIVE_TOOL="$BINDIR/wf_pcap_stats"
+[[ -x "$NATIVE_TOOL" ]] && [[ "$WF_PCAP_USE_TSHARK" == "" ]] && exec $NATIVE_TOOL "$@"
+
 chk_prerequisites()
 {
     while [ "$1" != "" ]; do
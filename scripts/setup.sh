@@ -142,6 +142,7 @@ chk_prerequisite()
 	chk_cmd_present jq
 	chk_cmd_present libtool
 	chk_cmd_present graphviz
+	chk_cmd_present zlib1g-dev
 }
 
 git_submodule_dload()
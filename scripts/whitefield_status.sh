@@ -24,7 +24,7 @@ function main()
 
 	get_node_list
 	echo "Node count: $nodecnt"
-	[[ $dead_nodecnt -gt 0 ]] && echo "ALARM: $dead_nodecnt NODES DEFUNCT! CHECK STACKLINE."
+	[[ $dead_nodecnt -gt 0 ]] && echo "ALARM: $dead_nodecnt NODES EXITED! CHECK STACKLINE (FK:cmd_node_status)."
 	get_route_list
 	echo ;
 
@@ -37,6 +37,7 @@ function main()
 	memusage=`pmap $wfpid | tail -1 | awk '{print $2}'`
 	echo "System load avg:${str/*:/}"
 	echo "Airline CPU:$pcpu%, Memory:$memusage"
+	echo "Per-core load:" `fk_cmd "cmd_cpu_load"`
 	echo ;
 
 	echo ;
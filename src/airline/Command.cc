@@ -22,16 +22,39 @@
 
 #include "Command.h"
 #include "mac_stats.h"
+#include "Nodeinfo.h"
+#include "Config.h"
+#include "MbufPool.h"
+#include "PktTrace.h"
+#include "PktRecord.h"
 
-int cmd_mac_stats(uint16_t nodeid, char *buf, int buflen)
+int cmd_mac_stats(cl_nodeid_t nodeid, char *buf, int buflen)
 {
 	return wf::Macstats::get_summary(nodeid, buf, buflen);
 }
 
+int cmd_mbuf_stats(cl_nodeid_t nodeid, char *buf, int buflen)
+{
+	return wf::MbufPool::get_summary(buf, buflen);
+}
+
+int cmd_trace_stats(cl_nodeid_t nodeid, char *buf, int buflen)
+{
+	return wf::PktTrace::get_summary(buf, buflen);
+}
+
+int cmd_record_stats(cl_nodeid_t nodeid, char *buf, int buflen)
+{
+	return wf::PktRecord::get_summary(buf, buflen);
+}
+
 void al_handle_cmd(msg_buf_t *mbuf)
 {
 	if(0) { } 
 	HANDLE_CMD(mbuf, cmd_mac_stats)
+	HANDLE_CMD(mbuf, cmd_mbuf_stats)
+	HANDLE_CMD(mbuf, cmd_trace_stats)
+	HANDLE_CMD(mbuf, cmd_record_stats)
 	else {
         char tmpbuf[256];
         snprintf(tmpbuf, sizeof(tmpbuf), "%s", mbuf->buf);
@@ -40,3 +63,27 @@ void al_handle_cmd(msg_buf_t *mbuf)
 	}
 }
 
+/* Handles MBUF_IS_CTRL msgs from the stackline. Returns the ctrl type
+ * handled so that the airline can update its PHY state, else FAILURE */
+int al_handle_ctrl(msg_buf_t *mbuf)
+{
+	wf::Nodeinfo *ni = WF_config.get_node_info(mbuf->src_id);
+
+	if (!ni || mbuf->len < 1) {
+		CERROR << "Invalid ctrl msg from id:" << mbuf->src_id << endl;
+		return FAILURE;
+	}
+	switch (mbuf->buf[0]) {
+		case CL_CTRL_RADIO_OFF:
+		case CL_CTRL_RADIO_ON:
+			ni->setRadioOff(mbuf->buf[0] == CL_CTRL_RADIO_OFF);
+			return mbuf->buf[0];
+		case CL_CTRL_NODE_RESTARTED:
+			CINFO << "Node:" << mbuf->src_id << " restarted, resetting its MAC state\n";
+			wf::Macstats::clear_node(mbuf->src_id);
+			ni->setRadioOff(0);
+			return mbuf->buf[0];
+	}
+	CERROR << "Unknown ctrl msg type:" << (int)mbuf->buf[0] << endl;
+	return FAILURE;
+}
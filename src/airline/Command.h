@@ -27,5 +27,6 @@ extern "C" {
 }
 
 void al_handle_cmd(msg_buf_t *mbuf);
+int  al_handle_ctrl(msg_buf_t *mbuf);
 
 #endif // _COMMAND_H_
@@ -23,6 +23,7 @@
 #include <common.h>
 #include <Nodeinfo.h>
 #include <Config.h>
+#include <PktRecord.h>
 extern "C" {
 #include "commline/commline.h"
 }
@@ -70,7 +71,7 @@ char *Config::getNextCmdToken(char *ptr, char **state, char *tok, int tok_len)
 	return tok;
 }
 
-void Config::resolveToken(char *tok, int tok_len, uint16_t nodeID)
+void Config::resolveToken(char *tok, int tok_len, cl_nodeid_t nodeID)
 {
 	char tmp[32];
 	char *ptr = strchr(tok, '$'); 
@@ -98,7 +99,7 @@ void Config::resolveToken(char *tok, int tok_len, uint16_t nodeID)
 	}
 }
 
-void Config::cmdParser(string & cmd, uint16_t nodeID)
+void Config::cmdParser(string & cmd, cl_nodeid_t nodeID)
 {
 	char buf[1024], tok[512];
 	char *ptr = (char *)cmd.c_str(), *saveptr=NULL;
@@ -120,19 +121,39 @@ void Config::cmdParser(string & cmd, uint16_t nodeID)
 	cmd = str;
 }
 
-void Config::spawnStackline(const uint16_t nodeID)
+void Config::spawnStackline(const cl_nodeid_t nodeID)
 {
 	uint8_t buf[sizeof(msg_buf_t) + COMMLINE_MAX_BUF];
 	msg_buf_t *mbuf = (msg_buf_t*)buf;
 	int len=0;
-	string cmd = nodeArray[nodeID].getNodeExecutable();
+	string cmd = getNodeCfg(nodeID, "nodeExec");
 
+	if(PktRecord::replay()) {
+		return; // wf_replay stands in for the stacklines
+	}
 	if(cmd.empty()) {
 		ERROR("No Stackline exec configured for nodeID:%d\n", nodeID);
 		WF_STOP;
 	}
 
 	cmdParser(cmd, nodeID);
+	// node range settings applied by the forker, see forker.c
+	static const char *fkTokens[][2] = {
+		{ "nodeRestart", "WF_RESTART=" },
+		{ "nodeCpuSet",  "WF_CPUSET="  },
+		{ "nodeCgroup",  "WF_CGROUP="  },
+		{ "nodeKsm",     "WF_KSM="     },
+		{ "nodeLogRate", "WF_LOGRATE=" },
+	};
+	for(auto &t : fkTokens) {
+		string val = getNodeCfg(nodeID, t[0]);
+		if(val.empty()) {
+			val = get(t[0], "");
+		}
+		if(!val.empty()) {
+			cmd += string("|") + t[1] + val;
+		}
+	}
 	INFO("spawning node:%d Exec:%s\n", nodeID, cmd.c_str());
 	len = snprintf((char *)mbuf->buf, COMMLINE_MAX_BUF, "%s", cmd.c_str());
 	mbuf->len = len;
@@ -140,7 +161,7 @@ void Config::spawnStackline(const uint16_t nodeID)
 	if(SUCCESS != cl_sendto_q(MTYPE(FORKER, CL_MGR_ID), mbuf, len + sizeof(msg_buf_t))) {
 		ERROR("Failure sending command to forker\n");
 	}
-	if(nodeID == getNumberOfNodes()-1) {
+	if(nodeID == (cl_nodeid_t)getNumberOfNodes()-1) {
 		INFO("All nodes started.\n");
 	}
 }
@@ -175,24 +196,6 @@ string Config::getKeyRange(const string & keystr, int & beg_range, int & end_ran
 	return key;
 }
 
-int Config::setNodeSetExec(const string exec, int beg, int end)
-{
-	int i;
-	for(i=beg;i<=end;i++) {
-		nodeArray[i].setNodeExecutable(exec);
-	}
-	return SUCCESS;
-}
-
-int Config::setNodeSetCapFile(const string path, int beg, int end)
-{
-	int i;
-	for(i=beg;i<=end;i++) {
-		nodeArray[i].setNodeCaptureFile(path);
-	}
-	return SUCCESS;
-}
-
 int Config::setNodePosition(const string position, int beg, int end)
 {
 	int i;
@@ -217,12 +220,21 @@ int Config::setNodePromis(const string pmode, int beg, int end)
 	return SUCCESS;
 }
 
-int Config::setNodeKV(string key, string val, int beg, int end)
+uint32_t Config::internVal(const string &val)
 {
-	int i;
-	for (i = beg; i <= end; i++) {
-		nodeArray[i].setkv(key, val);
+	auto it = valIdx.find(val);
+
+	if(it != valIdx.end()) {
+		return it->second;
 	}
+	valTbl.push_back(val);
+	valIdx[val] = valTbl.size() - 1;
+	return valTbl.size() - 1;
+}
+
+int Config::setNodeKV(string key, string val, int beg, int end)
+{
+	nodeKV[key].assign(beg, end, internVal(val));
 	return SUCCESS;
 }
 
@@ -262,10 +274,8 @@ int Config::setConfigurationFromFile(const char *fname)
                             end_range, getNumberOfNodes());
                     return FAILURE;
                 }
-				if(key == "nodeExec") {
-					setNodeSetExec(value, beg_range, end_range);
-				} else if(key == "captureFile") {
-					setNodeSetCapFile(value, beg_range, end_range);
+				if(key == "nodeExec" || key == "captureFile") {
+					setNodeKV(key, value, beg_range, end_range);
 				} else if(key == "nodePosition") {
 					setNodePosition(value, beg_range, end_range);
 				} else if(key == "nodePromiscuous") {
@@ -293,29 +303,43 @@ int Config::setConfigurationFromFile(const char *fname)
 	return SUCCESS;
 }
 
-Nodeinfo *Config::get_node_info(uint16_t id) 
+Nodeinfo *Config::get_node_info(cl_nodeid_t id) 
 {
-	if(!IN_RANGE(id, 0, getNumberOfNodes())) {
+	if(id >= (cl_nodeid_t)getNumberOfNodes()) {
 		return NULL;
 	}
 	return &nodeArray[id];
 }
 
-string Config::getNodeCfg(uint16_t id, string key)
+string Config::getNodeCfg(cl_nodeid_t id, string key)
 {
-    Nodeinfo *ni;
+    uint32_t val;
+    auto     it = nodeKV.find(key);
 
-    ni = get_node_info(id);
-    if (!ni) {
+    if (it == nodeKV.end() || !it->second.lookup(id, val)) {
         return string();
     }
+    return valTbl[val];
+}
 
-    return ni->getkv(key);
+/* Equivalent of key[id]=val in cfg, used by the topologyFile loader */
+int Config::setNodeCfg(cl_nodeid_t id, const string key, const string val)
+{
+	if(id >= (cl_nodeid_t)getNumberOfNodes()) {
+		ERROR("node idx(%d) out of bounds. Max nodes:%d\n",
+				id, getNumberOfNodes());
+		return FAILURE;
+	}
+	if(key == "nodePromiscuous") {
+		return setNodePromis(val, id, id);
+	}
+	return setNodeKV(key, val, id, id);
 }
 
 int Config::setNumberOfNodes(const int value)
 {
 	clearNodeArray();
+	nodeKV.clear();
 	nodeArray = new Nodeinfo [value];
 	numOfNodes = value;
 	return SUCCESS;
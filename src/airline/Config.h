@@ -22,6 +22,8 @@
 #define _CONFIG_H_
 
 #include <common.h>
+#include <unordered_map>
+#include <RangeMap.h>
 
 namespace wf {
 class Config {
@@ -31,9 +33,16 @@ private:
 
     map<string, string, ci_less> keyval;
 
+    /*
+     * Per-node cfg: every key has a RangeMap of node id ranges pointing
+     * into the interned value table.
+     */
+    map<string, RangeMap, ci_less>   nodeKV;
+    vector<string>                   valTbl;
+    unordered_map<string, uint32_t>  valIdx;
+
+    uint32_t internVal(const string &val);
     int setNumberOfNodes(const int value);
-    int setNodeSetExec(const string exec, int beg, int end);
-    int setNodeSetCapFile(const string path, int beg, int end);
     int setNodePosition(const string position, int beg, int end);
     int setNodePromis(const string pmode, int beg, int end);
     int setNodeKV(const string key, const string val, int beg, int end);
@@ -47,7 +56,7 @@ private:
     };
 
 public:
-    Nodeinfo *get_node_info(uint16_t id);
+    Nodeinfo *get_node_info(cl_nodeid_t id);
     string    get(string key)
     {
         return keyval[key];
@@ -62,12 +71,13 @@ public:
     {
         return numOfNodes;
     };
-    void   spawnStackline(const uint16_t nodeID);
-    void   cmdParser(string &cmd, uint16_t nodeID);
+    void   spawnStackline(const cl_nodeid_t nodeID);
+    void   cmdParser(string &cmd, cl_nodeid_t nodeID);
     char * getNextCmdToken(char *ptr, char **state, char *tok, int tok_len);
     void   copyBetweenPtr(char *sptr, char *eptr, char *tok, int tok_len);
-    void   resolveToken(char *tok, int tok_len, uint16_t nodeID);
-    string getNodeCfg(uint16_t id, string key);
+    void   resolveToken(char *tok, int tok_len, cl_nodeid_t nodeID);
+    string getNodeCfg(cl_nodeid_t id, string key);
+    int    setNodeCfg(cl_nodeid_t id, const string key, const string val);
 
     Config()
     {
@@ -0,0 +1,474 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Graph Airline: link matrix based frame delivery without NS3
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _GRAPHAIRLINE_CC_
+
+#include <poll.h>
+#include <time.h>
+#include <stdlib.h>
+
+#include <GraphAirline.h>
+#include <Command.h>
+#include <mac_stats.h>
+#include <PktTrace.h>
+#include <MbufPool.h>
+#include <PktRecord.h>
+
+/* 802.15.4 O-QPSK 2.4GHz timings */
+#define SYMBOL_US        16
+#define BYTE_US          (2 * SYMBOL_US)
+#define BACKOFF_US       (20 * SYMBOL_US)
+#define TURNAROUND_US    (12 * SYMBOL_US)
+#define ACK_WAIT_US      (54 * SYMBOL_US)
+#define PHY_HDR_LEN      6
+#define MAC_OVERHEAD_LEN 11
+#define ACK_FRAME_LEN    (PHY_HDR_LEN + 5)
+#define MIN_BE           3
+#define MAX_BE           5
+
+uint64_t GraphAirline::nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+glink_t *GraphAirline::getLink(cl_nodeid_t src, cl_nodeid_t dst)
+{
+    for (auto &l : links[src]) {
+        if (l.dst == dst) {
+            return &l;
+        }
+    }
+    return NULL;
+}
+
+void GraphAirline::setLink(cl_nodeid_t src, const glink_t &link)
+{
+    vector<glink_t> &v = links[src];
+
+    for (size_t i = 0; i < v.size(); i++) {
+        if (v[i].dst != link.dst) {
+            continue;
+        }
+        if (link.prr <= 0) {
+            v[i] = v.back();
+            v.pop_back();
+        } else {
+            v[i] = link;
+        }
+        return;
+    }
+    if (link.prr > 0) {
+        v.push_back(link);
+    }
+}
+
+/* Parses "<src> <dst> <prr> [delay_ms] [lqi]", every field is checked on its
+ * own so that a short or malformed line is rejected instead of reading 0 */
+static int parseLink(char *p, glink_upd_t &u)
+{
+    unsigned long v;
+    double        d;
+    char *        end;
+
+    u.src = strtoul(p, &end, 0);
+    if (end == p) {
+        return FAILURE;
+    }
+    u.link.dst = strtoul(p = end, &end, 0);
+    if (end == p) {
+        return FAILURE;
+    }
+    u.link.prr = strtof(p = end, &end);
+    if (end == p || u.link.prr < 0 || u.link.prr > 1) {
+        return FAILURE;
+    }
+    u.link.delay_us = 0;
+    u.link.lqi      = 255;
+    d               = strtod(p = end, &end);
+    if (end != p) {
+        if (d < 0) {
+            return FAILURE;
+        }
+        u.link.delay_us = d * 1000;
+        v               = strtoul(p = end, &end, 0);
+        if (end != p) {
+            if (v > 255) {
+                return FAILURE;
+            }
+            u.link.lqi = v;
+        }
+    }
+    while (isspace(*end)) end++;
+    return *end ? FAILURE : SUCCESS;
+}
+
+int GraphAirline::loadLinkMatrix(const string &path)
+{
+    char           line[512];
+    long           lineno = 0;
+    glink_epoch_t *epoch  = NULL;
+    FILE *         fp;
+
+    fp = fopen(path.c_str(), "r");
+    if (!fp) {
+        ERROR("could not open linkMatrixFile [%s] %m\n", path.c_str());
+        return FAILURE;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        glink_upd_t u;
+        char *      p = line, *end;
+
+        lineno++;
+        while (isspace(*p)) p++;
+        if (!*p || *p == '#') {
+            continue;
+        }
+        if (*p == '@') {
+            double sec = strtod(p + 1, &end);
+            if (end == p + 1 || (!epochs.empty() && sec * 1e6 < epochs.back().at_us)) {
+                ERROR("linkMatrixFile line %ld: invalid/decreasing time\n", lineno);
+                goto failure;
+            }
+            epochs.push_back({ (uint64_t)(sec * 1e6), {} });
+            epoch = &epochs.back();
+            continue;
+        }
+        if (parseLink(p, u) != SUCCESS || u.src >= nodes.size()
+            || u.link.dst >= nodes.size()) {
+            ERROR("linkMatrixFile line %ld: invalid link\n", lineno);
+            goto failure;
+        }
+        if (epoch) {
+            epoch->upd.push_back(u);
+        } else {
+            setLink(u.src, u.link);
+        }
+    }
+    fclose(fp);
+    return SUCCESS;
+failure:
+    fclose(fp);
+    return FAILURE;
+}
+
+bool GraphAirline::chance(float prr)
+{
+    return uniform_real_distribution<float>(0, 1)(rng) < prr;
+}
+
+void GraphAirline::schedule(uint64_t at_us, uint8_t type, cl_nodeid_t node,
+                            gframe_t frame, uint8_t status, uint8_t lqi)
+{
+    gevent_t ev;
+
+    ev.at_us  = at_us;
+    ev.seq    = evseq++;
+    ev.type   = type;
+    ev.status = status;
+    ev.lqi    = lqi;
+    ev.node   = node;
+    ev.frame  = frame;
+    evq.push(ev);
+}
+
+/* Schedules rx at dst if the frame makes it over the src->dst link */
+void GraphAirline::deliver(uint64_t at_us, cl_nodeid_t src, cl_nodeid_t dst,
+                           gframe_t &frame)
+{
+    glink_t *     l  = getLink(src, dst);
+    wf::Nodeinfo *ni = WF_config.get_node_info(dst);
+
+    if (l && ni && ni->isRadioOff()) {
+        wf::Macstats::set_rx_missed(dst);
+        return;
+    }
+    if (l && chance(l->prr)) {
+        schedule(at_us + l->delay_us, GEV_RX, dst, frame, 0, l->lqi);
+    }
+}
+
+void GraphAirline::startTx(cl_nodeid_t id)
+{
+    gnode_t &n = nodes[id];
+
+    n.busy  = 1;
+    n.tries = 0;
+    schedule(nowUs() + BACKOFF_US * (rng() % (1 << MIN_BE)), GEV_TX, id);
+}
+
+void GraphAirline::txAttempt(cl_nodeid_t id)
+{
+    gnode_t &  n     = nodes[id];
+    gframe_t   frame = n.txq.front();
+    msg_buf_t *mbuf  = (msg_buf_t *)frame->data();
+    uint64_t   now   = nowUs();
+    uint64_t   tx_us = (mbuf->len + MAC_OVERHEAD_LEN + PHY_HDR_LEN) * BYTE_US;
+    glink_t *  l;
+
+    n.tries++;
+    wf::PktTrace::macTx(mbuf);
+    if (mbuf->dst_id == CL_BCAST_ID || mbuf->dst_id == CL_DSTID_MACHDR_PRESENT) {
+        for (auto &nl : links[id]) {
+            deliver(now + tx_us, id, nl.dst, frame);
+        }
+        schedule(now + tx_us, GEV_TX_DONE, id, gframe_t(), WF_STATUS_ACK_OK);
+        return;
+    }
+
+    /* Promiscuous neighbours overhear the unicast */
+    for (auto &nl : links[id]) {
+        if (nl.dst != mbuf->dst_id && nodes[nl.dst].promis) {
+            deliver(now + tx_us, id, nl.dst, frame);
+        }
+    }
+    l = getLink(id, mbuf->dst_id);
+    if (l && WF_config.get_node_info(mbuf->dst_id)->isRadioOff()) {
+        wf::Macstats::set_rx_missed(mbuf->dst_id);
+        l = NULL;
+    }
+    if (l && chance(l->prr)) {
+        glink_t *rl = getLink(mbuf->dst_id, id);
+
+        schedule(now + tx_us + l->delay_us, GEV_RX, mbuf->dst_id, frame, 0, l->lqi);
+        if (chance(rl ? rl->prr : l->prr)) {
+            schedule(now + tx_us + TURNAROUND_US + ACK_FRAME_LEN * BYTE_US,
+                     GEV_TX_DONE, id, gframe_t(), WF_STATUS_ACK_OK);
+            return;
+        }
+    }
+    if (n.tries > macMaxRetry) {
+        schedule(now + tx_us + ACK_WAIT_US, GEV_TX_DONE, id, gframe_t(), WF_STATUS_NO_ACK);
+        return;
+    }
+    int be = min(MIN_BE + n.tries, MAX_BE);
+    schedule(now + tx_us + ACK_WAIT_US + BACKOFF_US * (rng() % (1 << be)), GEV_TX, id);
+}
+
+void GraphAirline::txDone(cl_nodeid_t id, uint8_t status)
+{
+    gnode_t &  n    = nodes[id];
+    msg_buf_t *mbuf = (msg_buf_t *)n.txq.front()->data();
+
+    if (mbuf->dst_id != CL_BCAST_ID && mbuf->dst_id != CL_DSTID_MACHDR_PRESENT) {
+        SendAckToStackline(id, mbuf->dst_id, status, n.tries);
+    }
+    n.txq.pop_front();
+    n.busy = 0;
+    if (!n.txq.empty()) {
+        startTx(id);
+    }
+}
+
+/* All the receivers share the queued frame, the per-receiver header fields
+ * are set only for the send and the sender's copy is restored after */
+void GraphAirline::rxFrame(cl_nodeid_t id, gframe_t &frame, uint8_t lqi)
+{
+    msg_buf_t *mbuf = (msg_buf_t *)frame->data();
+    msg_buf_t  hdr  = *mbuf;
+
+    mbuf->flags &= MBUF_HAS_TRACE;
+    mbuf->info.sig.lqi = lqi;
+    SendPacketToStackline(id, mbuf);
+    mbuf->flags = hdr.flags;
+    mbuf->info  = hdr.info;
+}
+
+void GraphAirline::handleEvent(gevent_t &ev)
+{
+    switch (ev.type) {
+    case GEV_TX:
+        txAttempt(ev.node);
+        break;
+    case GEV_TX_DONE:
+        txDone(ev.node, ev.status);
+        break;
+    case GEV_RX:
+        rxFrame(ev.node, ev.frame, ev.lqi);
+        break;
+    case GEV_EPOCH:
+        for (auto &u : epochs[ev.node].upd) {
+            setLink(u.src, u.link);
+        }
+        INFO("link matrix epoch %u applied, %zu updates\n",
+             ev.node, epochs[ev.node].upd.size());
+        break;
+    }
+}
+
+/* Usage: cmd_set_link:<src> <dst> <prr> [delay_ms] [lqi] */
+int GraphAirline::cmd_set_link(cl_nodeid_t id, char *buf, int buflen)
+{
+    glink_upd_t u;
+
+    if (parseLink(buf, u) != SUCCESS || u.src >= nodes.size()
+        || u.link.dst >= nodes.size()) {
+        return snprintf(buf, buflen, "usage: cmd_set_link:<src> <dst> <prr> [delay_ms] [lqi]");
+    }
+    setLink(u.src, u.link);
+    return snprintf(buf, buflen, "SUCCESS");
+}
+
+/* Events run on the wall clock, the drift is how late they run */
+int GraphAirline::cmd_sim_time(cl_nodeid_t id, char *buf, int buflen)
+{
+    uint64_t wall_us = nowUs() - start_us;
+
+    return snprintf(buf, buflen, "{\"wall_ms\":%lu,\"sim_ms\":%lu,\"drift_ms\":%lu}",
+                    wall_us / 1000, (wall_us - min(lag_us, wall_us)) / 1000, lag_us / 1000);
+}
+
+void GraphAirline::msgrecvCallback(msg_buf_t *mbuf)
+{
+    gnode_t *n;
+
+    wf::PktRecord::rx(mbuf);
+    if (mbuf->flags & MBUF_IS_CTRL) {
+        if (al_handle_ctrl(mbuf) == CL_CTRL_NODE_RESTARTED && mbuf->src_id < nodes.size()) {
+            // the in-flight head frame completes, frames queued by the old
+            // process are dropped
+            n = &nodes[mbuf->src_id];
+            n->txq.erase(next(n->txq.begin(), n->busy ? 1 : 0), n->txq.end());
+        }
+        return;
+    }
+    if (mbuf->flags & MBUF_IS_CMD) {
+        if (0) {
+        }
+        HANDLE_CMD(mbuf, cmd_set_link)
+        HANDLE_CMD(mbuf, cmd_sim_time)
+        else
+        {
+            al_handle_cmd(mbuf);
+        }
+        if (!(mbuf->flags & MBUF_DO_NOT_RESPOND)) {
+            cl_sendto_q(MTYPE(MONITOR, CL_MGR_ID), mbuf,
+                        mbuf->len + sizeof(msg_buf_t));
+        }
+        return;
+    }
+    if (mbuf->src_id >= nodes.size()) {
+        CERROR << "rcvd src id=" << mbuf->src_id << " out of range!!\n";
+        return;
+    }
+    n = &nodes[mbuf->src_id];
+    wf::PktTrace::rx(mbuf);
+    wf::Macstats::set_stats(AL_TX, mbuf);
+    if (n->txq.size() >= macPktQlen) {
+        if (mbuf->dst_id != CL_BCAST_ID && mbuf->dst_id != CL_DSTID_MACHDR_PRESENT) {
+            SendAckToStackline(mbuf->src_id, mbuf->dst_id, WF_STATUS_ERR, 0);
+        }
+        return;
+    }
+    wf::MbufPool::txCopied(wf::PktTrace::frameLen(mbuf));
+    n->txq.push_back(make_shared<vector<uint8_t> >((uint8_t *)mbuf,
+                                                   (uint8_t *)mbuf + wf::PktTrace::frameLen(mbuf)));
+    if (!n->busy) {
+        startTx(mbuf->src_id);
+    }
+}
+
+void GraphAirline::msgReader(void)
+{
+    DEFINE_MBUF(mbuf);
+
+    while (1) {
+        cl_recvfrom_q(MTYPE(AIRLINE, CL_MGR_ID),
+                      mbuf, sizeof(mbuf_buf), CL_FLAG_NOWAIT | wf::PktTrace::rxFlags());
+        if (!mbuf->len) {
+            break;
+        }
+        msgrecvCallback(mbuf);
+    }
+}
+
+int GraphAirline::startNetwork(wf::Config &cfg)
+{
+    struct pollfd pfd;
+    string        file = CFG("linkMatrixFile");
+
+    nodes.resize(cfg.getNumberOfNodes());
+    links.resize(cfg.getNumberOfNodes());
+    rng.seed(stoi(CFG("randSeed", "0xbabe"), nullptr, 0));
+    macMaxRetry = CFG_INT("macMaxRetry", 3);
+    macPktQlen  = CFG_INT("macPktQlen", 10);
+    if (file.empty()) {
+        CERROR << "graph airline needs linkMatrixFile in cfg\n";
+        return FAILURE;
+    }
+    if (loadLinkMatrix(file) != SUCCESS) {
+        return FAILURE;
+    }
+    for (size_t i = 0; i < nodes.size(); i++) {
+        wf::Nodeinfo *ni = WF_config.get_node_info(i);
+        nodes[i].promis  = ni && ni->getPromisMode();
+    }
+    wf::Macstats::clear();
+
+    pfd.fd     = cl_get_descriptor(MTYPE(AIRLINE, CL_MGR_ID));
+    pfd.events = POLLIN;
+    if (pfd.fd < 0) {
+        return FAILURE;
+    }
+    start_us = nowUs();
+    for (size_t i = 0; i < epochs.size(); i++) {
+        schedule(start_us + epochs[i].at_us, GEV_EPOCH, i);
+    }
+    CINFO << "Graph airline with " << nodes.size() << " nodes, "
+          << epochs.size() << " link epochs\n";
+    for (size_t i = 0; i < nodes.size(); i++) {
+        SPAWN_STACKLINE(i);
+    }
+
+    while (1) {
+        uint64_t        now = nowUs();
+        struct timespec ts  = { 0, 100 * 1000 * 1000 };
+
+        if (!evq.empty() && evq.top().at_us <= now) {
+            lag_us = 0;
+        }
+        while (!evq.empty() && evq.top().at_us <= now) {
+            gevent_t ev = evq.top();
+            evq.pop();
+            lag_us = max(lag_us, nowUs() - ev.at_us);
+            handleEvent(ev);
+        }
+        if (!evq.empty()) {
+            uint64_t wait = evq.top().at_us - now;
+            ts.tv_sec     = wait / 1000000;
+            ts.tv_nsec    = (wait % 1000000) * 1000;
+        }
+        if (ppoll(&pfd, 1, &ts, NULL) > 0) {
+            msgReader();
+        }
+    }
+    return SUCCESS;
+}
+
+GraphAirline::GraphAirline(wf::Config &cfg)
+{
+    evseq  = 0;
+    lag_us = 0;
+    if (startNetwork(cfg) != SUCCESS) {
+        CERROR << "Graph airline configuration failed\n";
+    }
+}
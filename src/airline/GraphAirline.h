@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Graph Airline: link matrix based frame delivery without NS3
+ *
+ * Frames are delivered over a static or time-varying link matrix with
+ * per-link PRR, delay and LQI. There is no PHY/spectrum simulation. ACKs,
+ * retries, CSMA backoff and the per-node MAC queue are modelled here so
+ * that the stacklines see the same commline behaviour as with NS3.
+ *
+ * Link matrix file (linkMatrixFile=):
+ *     # comment
+ *     <src> <dst> <prr> [delay_ms] [lqi]
+ *     @ <sec>
+ *     <src> <dst> <prr> [delay_ms] [lqi]
+ * Links are directed. Lines following "@ <sec>" are applied <sec> after the
+ * start, overriding earlier values of the same link. prr=0 removes a link.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _GRAPHAIRLINE_H_
+#define _GRAPHAIRLINE_H_
+
+#include <list>
+#include <queue>
+#include <memory>
+#include <random>
+
+#include <common.h>
+#include <Nodeinfo.h>
+#include <Config.h>
+
+typedef struct _glink_ {
+    cl_nodeid_t dst;
+    float       prr;
+    uint32_t    delay_us;
+    uint8_t     lqi;
+} glink_t;
+
+typedef struct _glink_upd_ {
+    cl_nodeid_t src;
+    glink_t     link;
+} glink_upd_t;
+
+typedef struct _glink_epoch_ {
+    uint64_t            at_us;
+    vector<glink_upd_t> upd;
+} glink_epoch_t;
+
+typedef shared_ptr<vector<uint8_t> > gframe_t;
+
+typedef struct _gnode_ {
+    list<gframe_t> txq;
+    uint8_t        busy : 1;
+    uint8_t        promis : 1;
+    uint8_t        tries;
+} gnode_t;
+
+enum {
+    GEV_TX,      // tx attempt of head of the queue
+    GEV_TX_DONE, // tx complete with status
+    GEV_RX,      // frame reception
+    GEV_EPOCH,   // link matrix update
+};
+
+typedef struct _gevent_ {
+    uint64_t    at_us;
+    uint64_t    seq; // keeps events at the same time in FIFO order
+    uint8_t     type;
+    uint8_t     status;
+    uint8_t     lqi;
+    cl_nodeid_t node;
+    gframe_t    frame;
+
+    bool operator>(const struct _gevent_ &e) const
+    {
+        return at_us > e.at_us || (at_us == e.at_us && seq > e.seq);
+    };
+} gevent_t;
+
+class GraphAirline {
+private:
+    vector<vector<glink_t> > links;
+    vector<glink_epoch_t>    epochs;
+    vector<gnode_t>          nodes;
+    priority_queue<gevent_t, vector<gevent_t>, greater<gevent_t> > evq;
+    mt19937  rng;
+    uint64_t evseq;
+    uint64_t start_us;
+    uint64_t lag_us; // worst lateness of the last batch of due events
+    int      macMaxRetry;
+    size_t   macPktQlen;
+
+    uint64_t nowUs(void);
+    int      loadLinkMatrix(const string &path);
+    glink_t *getLink(cl_nodeid_t src, cl_nodeid_t dst);
+    void     setLink(cl_nodeid_t src, const glink_t &link);
+    bool     chance(float prr);
+    void     schedule(uint64_t at_us, uint8_t type, cl_nodeid_t node,
+                      gframe_t frame = gframe_t(), uint8_t status = 0, uint8_t lqi = 0);
+    void     deliver(uint64_t at_us, cl_nodeid_t src, cl_nodeid_t dst, gframe_t &frame);
+    void     startTx(cl_nodeid_t id);
+    void     txAttempt(cl_nodeid_t id);
+    void     txDone(cl_nodeid_t id, uint8_t status);
+    void     rxFrame(cl_nodeid_t id, gframe_t &frame, uint8_t lqi);
+    void     handleEvent(gevent_t &ev);
+    void     msgrecvCallback(msg_buf_t *mbuf);
+    int      cmd_set_link(cl_nodeid_t id, char *buf, int buflen);
+    int      cmd_sim_time(cl_nodeid_t id, char *buf, int buflen);
+    void     msgReader(void);
+    int      startNetwork(wf::Config &cfg);
+
+public:
+    GraphAirline(wf::Config &cfg);
+};
+
+#endif // _GRAPHAIRLINE_H_
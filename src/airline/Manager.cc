@@ -22,6 +22,9 @@
 
 #include <Manager.h>
 #include <AirlineManager.h>
+#include <GraphAirline.h>
+#include <PktTrace.h>
+#include <PktRecord.h>
 
 Manager::Manager(wf::Config & cfg)
 {
@@ -30,8 +33,18 @@ Manager::Manager(wf::Config & cfg)
 
 int Manager::startManager(wf::Config & cfg)
 {
+	if (wf::PktTrace::open(CFG("traceFile")) != SUCCESS) {
+		return FAILURE;
+	}
+	if (wf::PktRecord::open(CFG("recordFile"), CFG_INT("replayMode", 0)) != SUCCESS) {
+		return FAILURE;
+	}
 	try {
-		AirlineManager airlineManager(cfg);
+		if (!stricmp(CFG("airlineBackend", "ns3"), "graph")) {
+			GraphAirline graphAirline(cfg);
+		} else {
+			AirlineManager airlineManager(cfg);
+		}
 	} catch (exception & e) {
 		CERROR << "Caught exception " << e.what() << endl;
 		return FAILURE;
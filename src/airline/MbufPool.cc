@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Preallocated mbufs for the airline rx/ack paths
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _MBUFPOOL_CC_
+
+#include <MbufPool.h>
+
+#define MBUF_POOL_CHUNK 16
+
+namespace wf {
+vector<msg_buf_t *> MbufPool::freeList;
+size_t              MbufPool::total;
+mbuf_stats_t        MbufPool::stats;
+
+msg_buf_t *MbufPool::get(void)
+{
+    msg_buf_t *mbuf;
+
+    if (freeList.empty()) {
+        size_t   sz    = sizeof(msg_buf_t) + COMMLINE_MAX_BUF;
+        uint8_t *chunk = new uint8_t[sz * MBUF_POOL_CHUNK];
+
+        for (int i = 0; i < MBUF_POOL_CHUNK; i++) {
+            freeList.push_back((msg_buf_t *)(chunk + i * sz));
+        }
+        total += MBUF_POOL_CHUNK;
+    }
+    mbuf = freeList.back();
+    freeList.pop_back();
+    memset(mbuf, 0, sizeof(msg_buf_t));
+    mbuf->max_len = COMMLINE_MAX_BUF;
+    stats.allocs++;
+    stats.zeroed += sizeof(msg_buf_t);
+    return mbuf;
+}
+
+void MbufPool::put(msg_buf_t *mbuf)
+{
+    freeList.push_back(mbuf);
+}
+
+int MbufPool::get_summary(char *buf, int buflen)
+{
+    uint64_t frames = stats.frames ? stats.frames : 1;
+
+    return snprintf(buf, buflen,
+                    "MBUF_POOL: total=%zu,free=%zu,allocs=%lu\n"
+                    "FRAMES: sent=%lu,zeroed=%lu,copied=%lu,txcopied=%lu,"
+                    "zeroed_per_frame=%.1f,copied_per_frame=%.1f,"
+                    "txcopied_per_frame=%.1f",
+                    total, freeList.size(), stats.allocs,
+                    stats.frames, stats.zeroed, stats.copied, stats.txcopied,
+                    (double)stats.zeroed / frames, (double)stats.copied / frames,
+                    (double)stats.txcopied / frames);
+}
+} // namespace wf
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Preallocated mbufs for the airline rx/ack paths
+ *
+ * DEFINE_MBUF zeroes the whole COMMLINE_MAX_BUF sized buffer on the stack
+ * for every frame. Mbufs from the pool are reused and only the header is
+ * zeroed; the payload is written by the caller and only header+len is sent.
+ * The payload copy remains: lr-wpan and PLC copy every received ns3 packet
+ * into the mbuf. Graph airline and fastwpan copy a frame once into their tx
+ * queue and fan it out from there without a per-receiver copy.
+ * The airline delivers frames from a single thread, hence no locking.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _MBUFPOOL_H_
+#define _MBUFPOOL_H_
+
+#include <common.h>
+
+namespace wf {
+typedef struct _mbuf_stats_ {
+    uint64_t allocs;
+    uint64_t zeroed; // bytes memset
+    uint64_t copied; // payload bytes copied into rx mbufs
+    uint64_t txcopied; // bytes copied into shared tx queue frames
+    uint64_t frames; // frames sent to stacklines
+} mbuf_stats_t;
+
+class MbufPool {
+private:
+    static vector<msg_buf_t *> freeList;
+    static size_t              total;
+    static mbuf_stats_t        stats;
+
+public:
+    static msg_buf_t *get(void);
+    static void       put(msg_buf_t *mbuf);
+    static void       copied(size_t len)
+    {
+        stats.copied += len;
+    };
+    static void txCopied(size_t len)
+    {
+        stats.txcopied += len;
+    };
+    static void sent(void)
+    {
+        stats.frames++;
+    };
+    static int get_summary(char *buf, int buflen);
+};
+
+/* Returns the mbuf to the pool when going out of scope */
+class PoolMbuf {
+private:
+    msg_buf_t *mbuf;
+
+public:
+    PoolMbuf()
+    {
+        mbuf = MbufPool::get();
+    };
+    ~PoolMbuf()
+    {
+        MbufPool::put(mbuf);
+    };
+    operator msg_buf_t *()
+    {
+        return mbuf;
+    };
+};
+} // namespace wf
+
+#define POOL_MBUF(MBUF)        \
+    wf::PoolMbuf MBUF##_pool; \
+    msg_buf_t *  MBUF = MBUF##_pool
+
+#endif // _MBUFPOOL_H_
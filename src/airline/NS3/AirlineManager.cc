@@ -33,34 +33,37 @@
 #include "Airline.h"
 #include "Command.h"
 #include "mac_stats.h"
+#include "PktTrace.h"
+#include "PktRecord.h"
 #include "IfaceHandler.h"
+#include "PosFile.h"
+#include "TopologyFile.h"
+#include "Mobility.h"
 
 ifaceCtx_t g_ifctx;
 
 int getNodeConfigVal(int id, char *key, char *val, int vallen)
 {
-	wf::Nodeinfo *ni=NULL;
-    ni=WF_config.get_node_info(id);
-    if (!ni) {
+    if (!WF_config.get_node_info(id)) {
         snprintf(val, vallen, "cudnot get nodeinfo id=%d", id);
         CERROR << "Unable to get node config\n";
         return 0;
     }
     if (!strcmp(key, "nodeexec")) {
         return snprintf(val, vallen, "%s", 
-                (char *)ni->getNodeExecutable().c_str());
+                WF_config.getNodeCfg(id, "nodeExec").c_str());
     }
     snprintf(val, vallen, "unknown key [%s]", key);
     CERROR << "Unknown key " << key << "\n";
     return 0;
 }
 
-int AirlineManager::cmd_node_exec(uint16_t id, char *buf, int buflen)
+int AirlineManager::cmd_node_exec(cl_nodeid_t id, char *buf, int buflen)
 {
     return getNodeConfigVal(id, (char *)"nodeexec", buf, buflen);
 }
 
-int AirlineManager::cmd_node_position(uint16_t id, char *buf, int buflen)
+int AirlineManager::cmd_node_position(cl_nodeid_t id, char *buf, int buflen)
 {
 	int n=0;
 	ofstream of;
@@ -82,7 +85,7 @@ int AirlineManager::cmd_node_position(uint16_t id, char *buf, int buflen)
 		if (! mob) continue;
 
 		Vector pos = mob->GetPosition (); 
-		if(id == 0xffff || id == node->GetId()) {
+		if(id == CL_MGR_ID || id == node->GetId()) {
 			if(of.is_open()) {
 				of << "Node " << node->GetId() << " Location= "
                    << pos.x << " " << pos.y << " " << pos.z << "\n"; 
@@ -100,13 +103,156 @@ int AirlineManager::cmd_node_position(uint16_t id, char *buf, int buflen)
 	return n;
 }
 
+/* Parses optional "beg-end" or "id" node range of the bulk pos cmds */
+static int getCmdNodeRange(cl_nodeid_t id, const char *range, int numNodes,
+        int & beg, int & end)
+{
+    beg = 0;
+    end = numNodes-1;
+    if (id != CL_MGR_ID) {
+        beg = end = id;
+    }
+    if (range) {
+        const char *ptr = strchr(range, '-');
+        beg = end = atoi(range);
+        if (ptr) {
+            end = atoi(ptr+1);
+        }
+    }
+    if (beg < 0 || end >= numNodes || beg > end) {
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/*
+ * Bulk position get. Usage: cmd_get_positions:<file> [beg-end]
+ * Writes the positions as a packed binary array (PosFile.h) to <file>.
+ */
+int AirlineManager::cmd_get_positions(cl_nodeid_t id, char *buf, int buflen)
+{
+	char *saveptr, *path, *range;
+	int beg, end;
+	vector<wf_posrec_t> recs;
+	NodeContainer const & nodes = NodeContainer::GetGlobal (); 
+
+	path = strtok_r(buf, " ", &saveptr);
+	if (!path) {
+		return snprintf(buf, buflen, "Usage: cmd_get_positions:<file> [beg-end]");
+	}
+	range = strtok_r(NULL, " ", &saveptr);
+	if (getCmdNodeRange(id, range, nodes.GetN(), beg, end) != SUCCESS) {
+		return snprintf(buf, buflen, "invalid node range");
+	}
+	recs.reserve(end-beg+1);
+	for (int i = beg; i <= end; i++) {
+		Ptr<MobilityModel> mob = nodes.Get(i)->GetObject<MobilityModel> (); 
+		if (!mob) continue;
+
+		Vector pos = mob->GetPosition (); 
+		recs.push_back({ (uint32_t)i, pos.x, pos.y, pos.z });
+	}
+	if (wf::posFileWrite(path, recs) != SUCCESS) {
+		return snprintf(buf, buflen, "could not write pos file");
+	}
+	return snprintf(buf, buflen, "SUCCESS count=%zu", recs.size());
+}
+
+void AirlineManager::setPositions(vector<wf_posrec_t> recs)
+{
+	NodeContainer const & nodes = NodeContainer::GetGlobal (); 
+
+	for (size_t i = 0; i < recs.size(); i++) {
+		Ptr<MobilityModel> mob = nodes.Get(recs[i].id)->GetObject<MobilityModel>();
+		if (!mob) continue;
+		mob->SetPosition(Vector(recs[i].x, recs[i].y, recs[i].z));
+	}
+}
+
+/*
+ * Bulk position set. Usage: cmd_set_positions:<file>
+ * <file> is a packed binary array (PosFile.h). All the moves are applied
+ * in a single simulator event.
+ */
+int AirlineManager::cmd_set_positions(cl_nodeid_t id, char *buf, int buflen)
+{
+	char *saveptr, *path;
+	vector<wf_posrec_t> recs;
+	uint32_t numNodes = NodeContainer::GetGlobal ().GetN();
+
+	path = strtok_r(buf, " ", &saveptr);
+	if (!path) {
+		return snprintf(buf, buflen, "Usage: cmd_set_positions:<file>");
+	}
+	if (wf::posFileRead(path, recs) != SUCCESS) {
+		return snprintf(buf, buflen, "could not read pos file");
+	}
+	for (size_t i = 0; i < recs.size(); i++) {
+		if (recs[i].id >= numNodes) {
+			return snprintf(buf, buflen, "invalid node id=%u at rec=%zu",
+                    recs[i].id, i);
+		}
+	}
+	Simulator::ScheduleNow (&AirlineManager::setPositions, this, recs);
+	return snprintf(buf, buflen, "SUCCESS count=%zu", recs.size());
+}
+
+/* Node specific cfg if set for the node's range else the global cfg */
+static string getNodeCfgOrDef(uint32_t id, string key)
+{
+	string val = WF_config.getNodeCfg(id, key);
+	return val.empty() ? CFG(key) : val;
+}
+
+/*
+ * Loads all node positions from topologyFile into a ListPositionAllocator
+ * in one pass. Per-node attributes in the file are applied to the config.
+ */
+static void setTopologyFromFile(MobilityHelper & mob, uint32_t numNodes)
+{
+	vector<wf_posrec_t> recs;
+	vector<wf_topoattr_t> attrs;
+	vector<uint8_t> pos_set(numNodes, 0);
+	vector<Vector> pos(numNodes);
+	string file = CFG("topologyFile");
+
+	if (wf::topoFileLoad(file.c_str(), recs, attrs) != SUCCESS) {
+		throw FAILURE;
+	}
+	for (auto & r : recs) {
+		if (r.id >= numNodes) {
+			CERROR << "topologyFile node id " << r.id
+				<< " out of bounds. Max nodes:" << numNodes << "\n";
+			throw FAILURE;
+		}
+		pos[r.id] = Vector(r.x, r.y, r.z);
+		pos_set[r.id] = 1;
+	}
+	Ptr<ListPositionAllocator> alloc = CreateObject<ListPositionAllocator>();
+	for (uint32_t i = 0; i < numNodes; i++) {
+		if (!pos_set[i]) {
+			CERROR << "topologyFile has no position for node " << i << "\n";
+			throw FAILURE;
+		}
+		alloc->Add(pos[i]);
+	}
+	for (auto & a : attrs) {
+		if (WF_config.setNodeCfg(a.id, a.key, a.val) != SUCCESS) {
+			throw FAILURE;
+		}
+	}
+	CINFO << "Using ListPositionAllocator with " << recs.size()
+		<< " positions from " << file << "\n";
+	mob.SetPositionAllocator(alloc);
+}
+
 void AirlineManager::setPositionAllocator(NodeContainer & nodes)
 {
 	MobilityHelper mobility;
-	mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-	//TODO: In the future this could support different types of mobility models
 
-	if(CFG("topologyType") == "grid") {
+	if(!CFG("topologyFile").empty()) {
+		setTopologyFromFile(mobility, nodes.GetN());
+	} else if(CFG("topologyType") == "grid") {
 		int gw=stoi(CFG("gridWidth"));
 		CINFO << "Using GridPositionAllocator\n";
 		mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
@@ -133,10 +279,53 @@ void AirlineManager::setPositionAllocator(NodeContainer & nodes)
               << CFG("topologyType") << " in cfg\n";
 		throw FAILURE;
 	}
-	mobility.Install (nodes);
+	/*
+	 * Mobility model is chosen per node. Nodes are installed in id order so
+	 * that the position allocator sequence remains the same as before.
+	 * Ns2Trace nodes are grouped by their param so that each trace is
+	 * played back only on the nodes configured with it.
+	 */
+	map<string, vector<Ptr<Node>>> ns2nodes;
+	for (uint32_t i = 0; i < nodes.GetN(); i++) {
+		string model = WF_config.getNodeCfg(i, "mobilityModel");
+		string param;
+
+		if (model.empty()) {
+			model = CFG("mobilityModel");
+			param = getNodeCfgOrDef(i, "mobilityModelParam");
+		} else {
+			/* Global param belongs to the global model, not this one */
+			param = WF_config.getNodeCfg(i, "mobilityModelParam");
+		}
+		if (setMobilityModel(mobility, model, param) != SUCCESS) {
+			throw FAILURE;
+		}
+		mobility.Install (nodes.Get(i));
+		if (!stricmp(model, "Ns2Trace")) {
+			vector<Ptr<Node>> & v = ns2nodes[param];
+			v.resize(nodes.GetN());
+			v[i] = nodes.Get(i);
+		}
+		nodes.Get(i)->GetObject<MobilityModel>()->TraceConnectWithoutContext(
+				"CourseChange", MakeBoundCallback(&AirlineManager::nodeMoved, i));
+	}
+	for (auto & t : ns2nodes) {
+		if (installNs2Trace(t.second, t.first) != SUCCESS) {
+			throw FAILURE;
+		}
+	}
 }
 
-int AirlineManager::cmd_802154_set_ext_addr(uint16_t id, char *buf, int buflen)
+/*
+ * Invoked whenever a node changes its course (position set, new waypoint,
+ * trace update). Lets the iface update any per-link state incrementally.
+ */
+void AirlineManager::nodeMoved(uint32_t id, Ptr<const MobilityModel> mob)
+{
+	ifaceNodeMoved(&g_ifctx, id);
+}
+
+int AirlineManager::cmd_802154_set_ext_addr(cl_nodeid_t id, char *buf, int buflen)
 {
     int ret = ifaceSetAddress(&g_ifctx, id, buf, buflen);
     if (ret == SUCCESS) {
@@ -145,14 +334,31 @@ int AirlineManager::cmd_802154_set_ext_addr(uint16_t id, char *buf, int buflen)
     return snprintf(buf, buflen, "FAILURE");
 }
 
-int AirlineManager::cmd_set_node_position(uint16_t id, char *buf, int buflen)
+/* Usage: cmd_802154_set_channel:<channel> for the given node id */
+int AirlineManager::cmd_802154_set_channel(cl_nodeid_t id, char *buf, int buflen)
+{
+    int   numNodes = stoi(CFG("numOfNodes"));
+    char *end;
+    long  ch = strtol(buf, &end, 10);
+
+    while (isspace(*end)) end++;
+    if (id >= (cl_nodeid_t)numNodes || end == buf || *end || ch < 11 || ch > 26) {
+        return snprintf(buf, buflen, "Usage: cmd_802154_set_channel:<channel 11..26>, nodeid mandatory");
+    }
+    if (ifaceSetChannel(&g_ifctx, id, ch) == SUCCESS) {
+        return snprintf(buf, buflen, "SUCCESS");
+    }
+    return snprintf(buf, buflen, "FAILURE");
+}
+
+int AirlineManager::cmd_set_node_position(cl_nodeid_t id, char *buf, int buflen)
 {
 	char *ptr, *saveptr;
 	double x, y, z=0;
 	NodeContainer const & nodes = NodeContainer::GetGlobal (); 
 	int numNodes = stoi(CFG("numOfNodes"));
 
-	if(!IN_RANGE(id, 0, numNodes)) {
+	if(id >= (cl_nodeid_t)numNodes) {
 		return snprintf(buf, buflen,
                 "NodeID mandatory for setting node pos id=%d", id);
 	}
@@ -174,17 +380,49 @@ int AirlineManager::cmd_set_node_position(uint16_t id, char *buf, int buflen)
 	return snprintf(buf, buflen, "SUCCESS");
 }
 
+/*
+ * Realtime drift: the wall clock time since Simulator::Run minus the time
+ * of the event being run. It grows when the airline cannot keep up.
+ */
+int AirlineManager::cmd_sim_time(cl_nodeid_t id, char *buf, int buflen)
+{
+	struct timespec ts;
+	int64_t wall_ms, sim_ms;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	wall_ms = (ts.tv_sec - m_runStart.tv_sec) * 1000 +
+		(ts.tv_nsec - m_runStart.tv_nsec) / 1000000;
+	sim_ms = Simulator::Now().GetMilliSeconds();
+	return snprintf(buf, buflen, "{\"wall_ms\":%ld,\"sim_ms\":%ld,\"drift_ms\":%ld}",
+			(long)wall_ms, (long)sim_ms, (long)(wall_ms - sim_ms));
+}
+
 void AirlineManager::msgrecvCallback(msg_buf_t *mbuf)
 {
 	NodeContainer const & n = NodeContainer::GetGlobal (); 
 	int numNodes = stoi(CFG("numOfNodes"));
 
+	wf::PktRecord::rx(mbuf);
+	if(mbuf->flags & MBUF_IS_CTRL) {
+		int ctrl = al_handle_ctrl(mbuf);
+		if(ctrl == CL_CTRL_RADIO_OFF || ctrl == CL_CTRL_RADIO_ON) {
+			ifaceSetRadio(&g_ifctx, mbuf->src_id, ctrl == CL_CTRL_RADIO_ON);
+		} else if(ctrl == CL_CTRL_NODE_RESTARTED) {
+			ifaceSetRadio(&g_ifctx, mbuf->src_id, 1);
+			ifaceNodeReset(&g_ifctx, mbuf->src_id);
+		}
+		return;
+	}
 	if(mbuf->flags & MBUF_IS_CMD) {
         if(0) {}
 		HANDLE_CMD(mbuf, cmd_node_exec)
 		HANDLE_CMD(mbuf, cmd_node_position)
 		HANDLE_CMD(mbuf, cmd_set_node_position)
+		HANDLE_CMD(mbuf, cmd_get_positions)
+		HANDLE_CMD(mbuf, cmd_set_positions)
 		HANDLE_CMD(mbuf, cmd_802154_set_ext_addr)	
+		HANDLE_CMD(mbuf, cmd_802154_set_channel)
+		HANDLE_CMD(mbuf, cmd_sim_time)
 		else {
 			al_handle_cmd(mbuf);
 		}
@@ -194,7 +432,7 @@ void AirlineManager::msgrecvCallback(msg_buf_t *mbuf)
         }
 		return;
 	}
-	if(!IN_RANGE(mbuf->src_id, 0, numNodes)) {
+	if(mbuf->src_id >= (cl_nodeid_t)numNodes) {
         CERROR << "rcvd src id=" << mbuf->src_id << " out of range!!\n";
 		return;
 	}
@@ -207,12 +445,13 @@ void AirlineManager::msgrecvCallback(msg_buf_t *mbuf)
             return;
         }
     }
+    wf::PktTrace::rx(mbuf);
     ifaceSendPacket(&g_ifctx, mbuf->src_id, mbuf);
     wf::Macstats::set_stats(AL_TX, mbuf);
 }
 
 void AirlineManager::nodePos(NodeContainer const & nodes, 
-        uint16_t id, double & x, double & y, double & z)
+        cl_nodeid_t id, double & x, double & y, double & z)
 {
 	MobilityHelper mob;
 	Ptr<ListPositionAllocator> positionAlloc = 
@@ -228,7 +467,7 @@ void AirlineManager::setNodeSpecificParam(NodeContainer & nodes)
 	uint8_t is_set=0;
 	double x, y, z;
 	wf::Nodeinfo *ni=NULL;
-    string txpower, deftxpower = CFG("txPower");
+    string txpower, deftxpower = CFG("txPower"), channel;
 
 	for(int i=0;i<(int)nodes.GetN();i++) {
 		ni = WF_config.get_node_info(i);
@@ -243,7 +482,11 @@ void AirlineManager::setNodeSpecificParam(NodeContainer & nodes)
 		if(ni->getPromisMode()) {
             ifaceSetPromiscuous(&g_ifctx, i);
         }
-        txpower = ni->getkv("txPower");
+        channel = getNodeCfgOrDef(i, "channel");
+        if (!channel.empty()) {
+            ifaceSetChannel(&g_ifctx, i, stoi(channel));
+        }
+        txpower = WF_config.getNodeCfg(i, "txPower");
         if (txpower.empty())
             txpower = deftxpower;
         if (!txpower.empty()) {
@@ -281,6 +524,7 @@ int AirlineManager::startNetwork(wf::Config & cfg)
 		ScheduleCommlineRX();
 		CINFO << "NS3 Simulator::Run initiated...\n";
         fflush(stdout);
+		clock_gettime(CLOCK_MONOTONIC, &m_runStart);
 		Simulator::Run ();
 		pause();
 		Simulator::Destroy ();
@@ -302,7 +546,7 @@ void AirlineManager::msgReader(void)
 	DEFINE_MBUF(mbuf);
 	while(1) {
 		cl_recvfrom_q(MTYPE(AIRLINE,CL_MGR_ID),
-                mbuf, sizeof(mbuf_buf), CL_FLAG_NOWAIT);
+                mbuf, sizeof(mbuf_buf), CL_FLAG_NOWAIT | wf::PktTrace::rxFlags());
 		if(mbuf->len) {
 			msgrecvCallback(mbuf);
 			usleep(1);
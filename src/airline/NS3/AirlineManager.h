@@ -24,9 +24,11 @@
 #include <common.h>
 #include <Nodeinfo.h>
 #include <Config.h>
+#include <PosFile.h>
 
 #include <ns3/node-container.h>
 #include <ns3/core-module.h>
+#include <ns3/mobility-model.h>
 
 using namespace ns3;
 
@@ -35,19 +37,26 @@ private:
     void    msgrecvCallback(msg_buf_t *mbuf);
     int     phyInstall(NodeContainer &nodes);
     int     startNetwork(wf::Config &cfg);
-    void    nodePos(NodeContainer const &nodes, uint16_t id, double &x, double &y, double &z);
-    int     cmd_node_exec(uint16_t id, char *buf, int buflen);
-    int     cmd_node_position(uint16_t id, char *buf, int buflen);
-    int     cmd_set_node_position(uint16_t id, char *buf, int buflen);
-    int     cmd_802154_set_short_addr(uint16_t id, char *buf, int buflen);
-    int     cmd_802154_set_ext_addr(uint16_t id, char *buf, int buflen);
-    int     cmd_802154_set_panid(uint16_t id, char *buf, int buflen);
+    void    nodePos(NodeContainer const &nodes, cl_nodeid_t id, double &x, double &y, double &z);
+    int     cmd_node_exec(cl_nodeid_t id, char *buf, int buflen);
+    int     cmd_node_position(cl_nodeid_t id, char *buf, int buflen);
+    int     cmd_set_node_position(cl_nodeid_t id, char *buf, int buflen);
+    int     cmd_get_positions(cl_nodeid_t id, char *buf, int buflen);
+    int     cmd_set_positions(cl_nodeid_t id, char *buf, int buflen);
+    void    setPositions(vector<wf_posrec_t> recs);
+    int     cmd_802154_set_short_addr(cl_nodeid_t id, char *buf, int buflen);
+    int     cmd_802154_set_ext_addr(cl_nodeid_t id, char *buf, int buflen);
+    int     cmd_802154_set_panid(cl_nodeid_t id, char *buf, int buflen);
+    int     cmd_802154_set_channel(cl_nodeid_t id, char *buf, int buflen);
+    int     cmd_sim_time(cl_nodeid_t id, char *buf, int buflen);
     void    setPositionAllocator(NodeContainer &nodes);
     void    setNodeSpecificParam(NodeContainer &nodes);
+    static void nodeMoved(uint32_t id, Ptr<const MobilityModel> mob);
     int     setAllNodesParam(NodeContainer &nodes);
     void    msgReader(void);
     void    ScheduleCommlineRX(void);
     EventId m_sendEvent;
+    struct timespec m_runStart;
 
 public:
     AirlineManager(wf::Config &cfg);
@@ -0,0 +1,582 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Lightweight 802.15.4 iface using SINR abstraction
+ *
+ * PHY=fastwpan models 802.15.4 2.4GHz O-QPSK with scalar rx power per link
+ * (cached, updated on tx power change and on course change), a SINR to PER
+ * lookup table, unslotted CSMA/CA, ACK and retries. Frames are received and
+ * interfere only on the channel they were sent on. There is no SpectrumValue
+ * arithmetic, no propagation delay and no NS3 net-device per node.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <algorithm>
+
+#include <ns3/simulator.h>
+#include <ns3/mobility-module.h>
+#include <ns3/random-variable-stream.h>
+
+#include <PropagationModel.h>
+#include <common.h>
+#include <Nodeinfo.h>
+#include <Config.h>
+#include <IfaceHandler.h>
+#include <PktTrace.h>
+#include <MbufPool.h>
+
+/* Unit is usec */
+#define FW_BYTE_US       32
+#define FW_BACKOFF_US    320
+#define FW_CCA_US        128
+#define FW_TURNAROUND_US 192
+#define FW_ACK_WAIT_US   864
+#define FW_AIR_KEEP_US   5000 // longer than the longest frame on air
+
+#define FW_PHY_OVERHEAD  6  // preamble, SFD, PHR
+#define FW_MAC_OVERHEAD  11 // FCF, seq, dst pan, short dst/src addr, FCS
+#define FW_ACK_LEN       (FW_PHY_OVERHEAD + 5)
+#define FW_MIN_BE        3
+#define FW_MAX_BE        5
+#define FW_MAX_BACKOFFS  4
+#define FW_MIN_CHANNEL   11
+#define FW_MAX_CHANNEL   26
+
+#define FW_NOISE_DBM     -106.0 // kTB for 2MHz with 5dB noise figure
+#define FW_SENSITIVITY   -106.0
+#define FW_LINK_CUTOFF   (FW_NOISE_DBM - 10) // links below this are ignored
+
+#define FW_SINR_MIN_DB   -10.0
+#define FW_SINR_MAX_DB   20.0
+#define FW_SINR_STEP_DB  0.25
+#define FW_SINR_TBL_SZ   ((int)((FW_SINR_MAX_DB - FW_SINR_MIN_DB) / FW_SINR_STEP_DB) + 1)
+
+typedef shared_ptr<vector<uint8_t> > fw_frame_t;
+
+typedef struct _fw_nbr_ {
+    cl_nodeid_t id;
+    float       rxDbm;
+} fw_nbr_t;
+
+typedef struct _fw_air_ {
+    cl_nodeid_t src;
+    int64_t     beg, end;
+    uint8_t     chan;
+    fw_frame_t  frame; // NULL for ACK
+} fw_air_t;
+
+typedef struct _fw_node_ {
+    deque<fw_frame_t> txq;
+    vector<fw_nbr_t>  nbrs; // sorted by id
+    double            txDbm;
+    uint8_t           dirty : 1;
+    uint8_t           busy : 1;
+    uint8_t           promis : 1;
+    uint8_t           ackOk : 1;
+    uint8_t           radioOff : 1;
+    uint8_t           nb, be, tries;
+    uint8_t           chan;
+} fw_node_t;
+
+static vector<fw_node_t>             g_fwNodes;
+static deque<shared_ptr<fw_air_t> >  g_air;
+static vector<Ptr<MobilityModel> >   g_mob;
+static Ptr<PropagationLossModel>     g_plm;
+static Ptr<UniformRandomVariable>    g_rand;
+static double                        g_berTbl[FW_SINR_TBL_SZ];
+static double                        g_ccaThreshold;
+static double                        g_sinrThreshold; // NAN for the PER table
+static int                           g_maxRetry;
+static size_t                        g_pktQlen;
+
+static void fwBackoff(cl_nodeid_t id);
+
+static inline double dbm2mw(double dbm)
+{
+    return pow(10.0, dbm / 10.0);
+}
+
+static inline int64_t nowUs(void)
+{
+    return Simulator::Now().GetMicroSeconds();
+}
+
+static inline bool isUnicast(cl_nodeid_t dst)
+{
+    return dst != CL_BCAST_ID && dst != CL_DSTID_MACHDR_PRESENT;
+}
+
+/* O-QPSK BER as used by ns3 LrWpanErrorModel, precomputed per SINR step */
+static void fwBerTblInit(void)
+{
+    for (int i = 0; i < FW_SINR_TBL_SZ; i++) {
+        double snr = dbm2mw(FW_SINR_MIN_DB + i * FW_SINR_STEP_DB);
+        double sum = 0, binom = 1;
+
+        for (int k = 1; k <= 16; k++) {
+            binom = binom * (16 - k + 1) / k;
+            if (k >= 2) {
+                sum += binom * ((k % 2) ? -1 : 1) * exp(20 * snr * (1.0 / k - 1.0));
+            }
+        }
+        g_berTbl[i] = min(max(8.0 / 15.0 / 16.0 * sum, 0.0), 0.5);
+    }
+}
+
+static bool fwDecode(double sinrDb, int len)
+{
+    int idx;
+
+    if (!std::isnan(g_sinrThreshold)) {
+        return sinrDb >= g_sinrThreshold;
+    }
+    if (sinrDb < FW_SINR_MIN_DB) {
+        return false;
+    }
+    idx = (int)((sinrDb - FW_SINR_MIN_DB) / FW_SINR_STEP_DB);
+    if (idx >= FW_SINR_TBL_SZ) {
+        return true;
+    }
+    return g_rand->GetValue() < pow(1 - g_berTbl[idx], len * 8);
+}
+
+static double fwCalcRxDbm(cl_nodeid_t src, cl_nodeid_t dst)
+{
+    return g_plm->CalcRxPower(g_fwNodes[src].txDbm, g_mob[src], g_mob[dst]);
+}
+
+static void fwUpdateRow(cl_nodeid_t id)
+{
+    fw_node_t &n = g_fwNodes[id];
+
+    n.nbrs.clear();
+    for (cl_nodeid_t j = 0; j < g_fwNodes.size(); j++) {
+        double rx;
+
+        if (j == id) {
+            continue;
+        }
+        rx = fwCalcRxDbm(id, j);
+        if (rx >= FW_LINK_CUTOFF) {
+            n.nbrs.push_back({ j, (float)rx });
+        }
+    }
+    n.dirty = 0;
+}
+
+static vector<fw_nbr_t> &fwNbrs(cl_nodeid_t id)
+{
+    if (g_fwNodes[id].dirty) {
+        fwUpdateRow(id);
+    }
+    return g_fwNodes[id].nbrs;
+}
+
+static vector<fw_nbr_t>::iterator fwFindNbr(vector<fw_nbr_t> &v, cl_nodeid_t id)
+{
+    return lower_bound(v.begin(), v.end(), id,
+                       [](const fw_nbr_t &a, cl_nodeid_t b) { return a.id < b; });
+}
+
+static double fwRxDbm(cl_nodeid_t src, cl_nodeid_t dst)
+{
+    vector<fw_nbr_t> &v  = fwNbrs(src);
+    auto              it = fwFindNbr(v, dst);
+
+    if (it == v.end() || it->id != dst) {
+        return -1000;
+    }
+    return it->rxDbm;
+}
+
+/* Updates the links towards the node in the rows already computed */
+static void fwUpdateCol(cl_nodeid_t id)
+{
+    for (cl_nodeid_t j = 0; j < g_fwNodes.size(); j++) {
+        vector<fw_nbr_t> &v = g_fwNodes[j].nbrs;
+        double            rx;
+
+        if (j == id || g_fwNodes[j].dirty) {
+            continue;
+        }
+        rx      = fwCalcRxDbm(j, id);
+        auto it = fwFindNbr(v, id);
+        if (it != v.end() && it->id == id) {
+            if (rx >= FW_LINK_CUTOFF) {
+                it->rxDbm = rx;
+            } else {
+                v.erase(it);
+            }
+        } else if (rx >= FW_LINK_CUTOFF) {
+            v.insert(it, { id, (float)rx });
+        }
+    }
+}
+
+static bool overlaps(const fw_air_t &a, const fw_air_t &b)
+{
+    return a.beg < b.end && b.beg < a.end;
+}
+
+/* Total power in mW at the node from the frames on air right now on the
+ * channel the node is tuned to */
+static double fwEnergyAt(cl_nodeid_t id)
+{
+    int64_t now = nowUs();
+    double  mw  = 0;
+
+    for (auto &a : g_air) {
+        if (a->beg <= now && now < a->end && a->src != id
+            && a->chan == g_fwNodes[id].chan) {
+            mw += dbm2mw(fwRxDbm(a->src, id));
+        }
+    }
+    return mw;
+}
+
+/* Returns the SINR in dB of the frame at the node or -1000 if the node
+ * was itself transmitting in the meantime (half duplex) */
+static double fwSinrAt(const fw_air_t &tx, cl_nodeid_t id, double rxDbm)
+{
+    double interf = dbm2mw(FW_NOISE_DBM);
+
+    for (auto &a : g_air) {
+        if (a.get() == &tx || !overlaps(*a, tx)) {
+            continue;
+        }
+        if (a->src == id) {
+            return -1000;
+        }
+        if (a->src != tx.src && a->chan == tx.chan) {
+            interf += dbm2mw(fwRxDbm(a->src, id));
+        }
+    }
+    return rxDbm - 10 * log10(interf);
+}
+
+static void fwAirAdd(shared_ptr<fw_air_t> air)
+{
+    int64_t old = nowUs() - FW_AIR_KEEP_US;
+
+    while (!g_air.empty() && g_air.front()->end < old) {
+        g_air.pop_front();
+    }
+    g_air.push_back(air);
+}
+
+/* The queued frame is sent as is, all the receivers share the buffer */
+static void fwDeliver(cl_nodeid_t id, fw_frame_t &frame, double rxDbm, double sinrDb)
+{
+    msg_buf_t *mbuf = (msg_buf_t *)frame->data();
+
+    mbuf->flags &= MBUF_HAS_TRACE;
+    /* LQI scaled linearly over 0-25dB SINR */
+    mbuf->info.sig.lqi  = (uint8_t)min(max(sinrDb * 255 / 25, 0.0), 255.0);
+    mbuf->info.sig.rssi = (int8_t)max(rxDbm, -128.0);
+    SendPacketToStackline(id, mbuf);
+}
+
+static void fwStartCsma(cl_nodeid_t id)
+{
+    fw_node_t &n = g_fwNodes[id];
+
+    n.busy  = 1;
+    n.ackOk = 0;
+    n.tries = 0;
+    n.nb    = 0;
+    n.be    = FW_MIN_BE;
+    fwBackoff(id);
+}
+
+static void fwTxDone(cl_nodeid_t id, uint8_t status)
+{
+    fw_node_t &n    = g_fwNodes[id];
+    msg_buf_t *mbuf = (msg_buf_t *)n.txq.front()->data();
+
+    if (isUnicast(mbuf->dst_id)) {
+        SendAckToStackline(id, mbuf->dst_id, status, n.tries + 1);
+    }
+    n.txq.pop_front();
+    n.busy = 0;
+    if (!n.txq.empty()) {
+        fwStartCsma(id);
+    }
+}
+
+static void fwAckTimeout(cl_nodeid_t id)
+{
+    fw_node_t &n = g_fwNodes[id];
+
+    if (n.ackOk) {
+        fwTxDone(id, WF_STATUS_ACK_OK);
+    } else if (n.tries < g_maxRetry) {
+        n.tries++;
+        n.nb = 0;
+        n.be = FW_MIN_BE;
+        fwBackoff(id);
+    } else {
+        fwTxDone(id, WF_STATUS_NO_ACK);
+    }
+}
+
+static void fwAckEnd(shared_ptr<fw_air_t> ack, cl_nodeid_t orig)
+{
+    double rx = fwRxDbm(ack->src, orig);
+
+    if (g_fwNodes[orig].chan != ack->chan) {
+        return;
+    }
+    if (rx >= FW_SENSITIVITY && fwDecode(fwSinrAt(*ack, orig, rx), FW_ACK_LEN)) {
+        g_fwNodes[orig].ackOk = 1;
+    }
+}
+
+static void fwAckStart(cl_nodeid_t id, cl_nodeid_t orig)
+{
+    shared_ptr<fw_air_t> ack = make_shared<fw_air_t>();
+
+    ack->src  = id;
+    ack->chan = g_fwNodes[id].chan;
+    ack->beg = nowUs();
+    ack->end = ack->beg + FW_ACK_LEN * FW_BYTE_US;
+    fwAirAdd(ack);
+    Simulator::Schedule(MicroSeconds(ack->end - ack->beg), &fwAckEnd, ack, orig);
+}
+
+static void fwTxEnd(shared_ptr<fw_air_t> tx)
+{
+    fw_node_t &n     = g_fwNodes[tx->src];
+    msg_buf_t *mbuf  = (msg_buf_t *)tx->frame->data();
+    int        len   = mbuf->len + FW_PHY_OVERHEAD;
+    bool       dstOk = false;
+
+    if (mbuf->dst_id != CL_DSTID_MACHDR_PRESENT) {
+        len += FW_MAC_OVERHEAD;
+    }
+    for (auto &nbr : fwNbrs(tx->src)) {
+        bool   isDst = nbr.id == mbuf->dst_id;
+        double sinr;
+
+        if (nbr.rxDbm < FW_SENSITIVITY || g_fwNodes[nbr.id].chan != tx->chan) {
+            continue;
+        }
+        if (isUnicast(mbuf->dst_id) && !isDst && !g_fwNodes[nbr.id].promis) {
+            continue;
+        }
+        if (g_fwNodes[nbr.id].radioOff) {
+            wf::Macstats::set_rx_missed(nbr.id);
+            continue;
+        }
+        sinr = fwSinrAt(*tx, nbr.id, nbr.rxDbm);
+        if (!fwDecode(sinr, len)) {
+            continue;
+        }
+        dstOk |= isDst;
+        fwDeliver(nbr.id, tx->frame, nbr.rxDbm, sinr);
+    }
+
+    /* No L2 ACK for bcast or if the src is in promiscuous mode */
+    if (!isUnicast(mbuf->dst_id) || n.promis) {
+        fwTxDone(tx->src, WF_STATUS_ACK_OK);
+        return;
+    }
+    if (dstOk) {
+        Simulator::Schedule(MicroSeconds(FW_TURNAROUND_US), &fwAckStart,
+                            mbuf->dst_id, tx->src);
+    }
+    Simulator::Schedule(MicroSeconds(FW_ACK_WAIT_US), &fwAckTimeout, tx->src);
+}
+
+static void fwTxStart(cl_nodeid_t id)
+{
+    fw_node_t &          n    = g_fwNodes[id];
+    shared_ptr<fw_air_t> tx   = make_shared<fw_air_t>();
+    msg_buf_t *          mbuf = (msg_buf_t *)n.txq.front()->data();
+    int                  len  = mbuf->len + FW_PHY_OVERHEAD;
+
+    if (mbuf->dst_id != CL_DSTID_MACHDR_PRESENT) {
+        len += FW_MAC_OVERHEAD;
+    }
+    tx->src   = id;
+    tx->chan  = n.chan;
+    tx->frame = n.txq.front();
+    tx->beg   = nowUs();
+    tx->end   = tx->beg + len * FW_BYTE_US;
+    wf::PktTrace::macTx(mbuf);
+    fwAirAdd(tx);
+    Simulator::Schedule(MicroSeconds(tx->end - tx->beg), &fwTxEnd, tx);
+}
+
+static void fwCca(cl_nodeid_t id)
+{
+    fw_node_t &n = g_fwNodes[id];
+
+    if (10 * log10(fwEnergyAt(id) + 1e-30) < g_ccaThreshold) {
+        Simulator::Schedule(MicroSeconds(FW_CCA_US + FW_TURNAROUND_US), &fwTxStart, id);
+        return;
+    }
+    n.nb++;
+    n.be = min(n.be + 1, FW_MAX_BE);
+    if (n.nb > FW_MAX_BACKOFFS) {
+        fwTxDone(id, WF_STATUS_ERR); // channel access failure
+        return;
+    }
+    fwBackoff(id);
+}
+
+static void fwBackoff(cl_nodeid_t id)
+{
+    fw_node_t &n     = g_fwNodes[id];
+    uint32_t   slots = g_rand->GetInteger(0, (1 << n.be) - 1);
+
+    Simulator::Schedule(MicroSeconds(slots * FW_BACKOFF_US), &fwCca, id);
+}
+
+static int fwSetup(ifaceCtx_t *ctx)
+{
+    string loss_model = CFG("lossModel", "LogDistance");
+
+    INFO("setting up fastwpan\n");
+    g_plm = getLossModel(loss_model, CFG("lossModelParam"));
+    if (!g_plm) {
+        return FAILURE;
+    }
+    if (!CFG("delayModel").empty()) {
+        CERROR << "fastwpan ignores delayModel\n";
+    }
+    g_rand          = CreateObject<UniformRandomVariable>();
+    g_ccaThreshold  = stod(CFG("fastwpanCcaThreshold", "-96"));
+    g_sinrThreshold = NAN;
+    if (!CFG("fastwpanSinrThreshold").empty()) {
+        g_sinrThreshold = stod(CFG("fastwpanSinrThreshold"));
+    }
+    g_maxRetry      = CFG_INT("macMaxRetry", 3);
+    g_pktQlen       = CFG_INT("macPktQlen", 10);
+    fwBerTblInit();
+
+    g_fwNodes.resize(ctx->nodes.GetN());
+    g_mob.resize(ctx->nodes.GetN());
+    for (uint32_t i = 0; i < ctx->nodes.GetN(); i++) {
+        g_mob[i] = ctx->nodes.Get(i)->GetObject<MobilityModel>();
+        if (!g_mob[i]) {
+            CERROR << "fastwpan needs mobility model on node " << i << "\n";
+            return FAILURE;
+        }
+        g_fwNodes[i].txDbm = 0;
+        g_fwNodes[i].dirty = 1;
+        g_fwNodes[i].chan  = FW_MIN_CHANNEL;
+    }
+    INFO("Using fastwpan as PHY\n");
+    return SUCCESS;
+}
+
+static int fwSetTxPower(ifaceCtx_t *ctx, int id, double txpow)
+{
+    INFO("Node:%d txpower:%f\n", id, txpow);
+    g_fwNodes[id].txDbm = txpow;
+    g_fwNodes[id].dirty = 1;
+    return SUCCESS;
+}
+
+static int fwSetChannel(ifaceCtx_t *ctx, int id, int ch)
+{
+    if (ch < FW_MIN_CHANNEL || ch > FW_MAX_CHANNEL) {
+        CERROR << "invalid fastwpan channel " << ch << "\n";
+        return FAILURE;
+    }
+    INFO("Node:%d channel:%d\n", id, ch);
+    g_fwNodes[id].chan = ch;
+    return SUCCESS;
+}
+
+static int fwSetRadio(ifaceCtx_t *ctx, int id, int on)
+{
+    g_fwNodes[id].radioOff = !on;
+    return SUCCESS;
+}
+
+/* The in-flight head frame is left to complete, the rest are dropped */
+static void fwNodeReset(ifaceCtx_t *ctx, int id)
+{
+    fw_node_t &n = g_fwNodes[id];
+
+    n.txq.erase(n.txq.begin() + (n.busy ? 1 : 0), n.txq.end());
+    n.radioOff = 0;
+}
+
+static int fwSetPromiscuous(ifaceCtx_t *ctx, int id)
+{
+    INFO("Set promis mode for fastwpan iface node:%d\n", id);
+    g_fwNodes[id].promis = 1;
+    return SUCCESS;
+}
+
+static int fwSetAddress(ifaceCtx_t *ctx, int id, const char *buf, int sz)
+{
+    return SUCCESS; // frames are addressed by node id
+}
+
+static int fwSendPacket(ifaceCtx_t *ctx, int id, msg_buf_t *mbuf)
+{
+    fw_node_t &n = g_fwNodes[id];
+
+    if (mbuf->flags & MBUF_IS_CMD) {
+        CERROR << "MBUF CMD not handled in Airline... No need!" << endl;
+        return FAILURE;
+    }
+    if (n.txq.size() >= g_pktQlen) {
+        if (isUnicast(mbuf->dst_id)) {
+            SendAckToStackline(id, mbuf->dst_id, WF_STATUS_ERR, 0);
+        }
+        return SUCCESS;
+    }
+    wf::MbufPool::txCopied(wf::PktTrace::frameLen(mbuf));
+    n.txq.push_back(make_shared<vector<uint8_t> >((uint8_t *)mbuf,
+                                                  (uint8_t *)mbuf + wf::PktTrace::frameLen(mbuf)));
+    if (!n.busy) {
+        fwStartCsma(id);
+    }
+    return SUCCESS;
+}
+
+static void fwNodeMoved(ifaceCtx_t *ctx, int id)
+{
+    g_fwNodes[id].dirty = 1;
+    fwUpdateCol(id);
+}
+
+static void fwCleanup(ifaceCtx_t *ctx)
+{
+    g_air.clear();
+    g_fwNodes.clear();
+    g_mob.clear();
+}
+
+ifaceApi_t fastwpanIface = {
+    setup          : fwSetup,
+    setTxPower     : fwSetTxPower,
+    setPromiscuous : fwSetPromiscuous,
+    setAddress     : fwSetAddress,
+    sendPacket     : fwSendPacket,
+    nodeMoved      : fwNodeMoved,
+    setChannel     : fwSetChannel,
+    setRadio       : fwSetRadio,
+    nodeReset      : fwNodeReset,
+    cleanup        : fwCleanup,
+};
@@ -26,14 +26,16 @@
 #include <IfaceHandler.h>
 
 extern ifaceApi_t lrwpanIface;
+extern ifaceApi_t fastwpanIface;
 #if PLC
 extern ifaceApi_t plcIface;
 #endif
 
 ifaceApi_t g_iflist[IFACE_MAX] = {
-    [IFACE_LRWPAN] = lrwpanIface,
+    [IFACE_LRWPAN]   = lrwpanIface,
+    [IFACE_FASTWPAN] = fastwpanIface,
 #if PLC
-    [IFACE_PLC]    = plcIface
+    [IFACE_PLC]      = plcIface
 #endif
 };
 
@@ -43,6 +45,7 @@ ifaceApi_t *getIfaceApi(ifaceCtx_t *ctx)
     string phy = CFG("PHY");
 
     if (!stricmp(phy, "plc")) iftype = IFACE_PLC;
+    if (!stricmp(phy, "fastwpan")) iftype = IFACE_FASTWPAN;
     return &g_iflist[iftype];
 }
 
@@ -50,14 +50,19 @@ typedef struct _iface_ {
     int (*setPromiscuous)(ifaceCtx_t *ctx, int id);
     int (*setAddress)(ifaceCtx_t *ctx, int id, const char *buf, int sz);
     int (*sendPacket)(ifaceCtx_t *ctx, int id, msg_buf_t *mbuf);
+    void (*nodeMoved)(ifaceCtx_t *ctx, int id); // optional
+    int (*setChannel)(ifaceCtx_t *ctx, int id, int channel);
+    int (*setRadio)(ifaceCtx_t *ctx, int id, int on); // optional
+    void (*nodeReset)(ifaceCtx_t *ctx, int id); // optional, drop queued frames
     void (*cleanup)(ifaceCtx_t *ctx);
 
     uint8_t inited : 1;
 } ifaceApi_t;
 
 typedef enum {
-    IFACE_LRWPAN, // lr-wpan
-    IFACE_PLC,    // Power Line Comm
+    IFACE_LRWPAN,   // lr-wpan
+    IFACE_FASTWPAN, // lr-wpan with SINR abstraction, no spectrum model
+    IFACE_PLC,      // Power Line Comm
     IFACE_MAX
 } IfaceType;
 
@@ -108,4 +113,43 @@ static inline int ifaceSendPacket(ifaceCtx_t *ctx, int id,
     return iface->sendPacket(ctx, id, mbuf);
 }
 
+static inline int ifaceSetChannel(ifaceCtx_t *ctx, int id, int channel)
+{
+    ifaceApi_t *iface;
+
+    GET_IFACE(ctx, iface, setChannel);
+    return iface->setChannel(ctx, id, channel);
+}
+
+/* Radio off/on of duty cycling stacklines. Delivery to a radio-off node is
+ * anyways dropped before the stackline, the iface may skip the PHY work */
+static inline void ifaceSetRadio(ifaceCtx_t *ctx, int id, int on)
+{
+    ifaceApi_t *iface = getIfaceApi(ctx);
+
+    if (iface && iface->inited && iface->setRadio) {
+        iface->setRadio(ctx, id, on);
+    }
+}
+
+/* Stackline was restarted, frames queued by the old process are stale */
+static inline void ifaceNodeReset(ifaceCtx_t *ctx, int id)
+{
+    ifaceApi_t *iface = getIfaceApi(ctx);
+
+    if (iface && iface->inited && iface->nodeReset) {
+        iface->nodeReset(ctx, id);
+    }
+}
+
+/* Called on every course change, hence no error if iface does not care */
+static inline void ifaceNodeMoved(ifaceCtx_t *ctx, int id)
+{
+    ifaceApi_t *iface = getIfaceApi(ctx);
+
+    if (iface && iface->inited && iface->nodeMoved) {
+        iface->nodeMoved(ctx, id);
+    }
+}
+
 #endif // _IFACEHANDLER_H_
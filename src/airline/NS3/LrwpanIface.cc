@@ -18,6 +18,8 @@
  * @}
  */
 
+#include <cmath>
+
 #include <ns3/single-model-spectrum-channel.h>
 #include <ns3/mobility-module.h>
 #include <ns3/lr-wpan-module.h>
@@ -28,6 +30,8 @@
 #include <Nodeinfo.h>
 #include <Config.h>
 #include <IfaceHandler.h>
+#include <MbufPool.h>
+#include <PktTrace.h>
 
 static Ptr<LrWpanNetDevice> getDev(ifaceCtx_t *ctx, int id)
 {
@@ -62,22 +66,63 @@ static uint8_t wf_ack_status(LrWpanMcpsDataConfirmStatus status)
     }
 }
 
-static uint16_t addr2id(const Mac16Address addr)
+/*
+ * Short (16 bit) MAC addresses are used as long as all the node ids fit in
+ * it. Otherwise extended addresses derived from the node id are used. Since
+ * the DataConfirm does not carry the ext dst addr, the dst of the in-flight
+ * unicast frames is remembered against the msdu handle.
+ */
+static bool g_useExtAddr;
+static vector<uint8_t> g_msduHandle;
+static map<uint64_t, cl_nodeid_t> g_extInflight;
+
+#define INFLIGHT_KEY(ID, HANDLE) (((uint64_t)(ID) << 8) | (HANDLE))
+
+static cl_nodeid_t addr2id(const Mac16Address addr)
+{
+    uint8_t str[2];
+
+    addr.CopyTo(str);
+    if (str[0] == 0xff && str[1] == 0xff) {
+        return CL_BCAST_ID;
+    }
+    return (str[0] << 8) | str[1];
+}
+
+static cl_nodeid_t extAddr2id(const Mac64Address addr)
 {
-    uint16_t id=0;
-    uint8_t str[2], *ptr=(uint8_t *)&id;
+    uint8_t str[8];
+
     addr.CopyTo(str);
-    ptr[1] = str[0];
-    ptr[0] = str[1];
-    return id;
+    return cl_get_longaddr2id(str);
+}
+
+static Mac64Address id2extAddr(const cl_nodeid_t id)
+{
+    Mac64Address mac;
+    uint8_t str[8];
+
+    cl_get_id2longaddr(id, str, sizeof(str));
+    mac.CopyFrom(str);
+    return mac;
 }
 
 static void DataConfirm (int id, McpsDataConfirmParams params)
 {
-    uint16_t dst_id = addr2id(params.m_addrShortDstAddr);
+    cl_nodeid_t dst_id;
     uint8_t status;
 
-    if(dst_id == 0xffff) {
+    if (g_useExtAddr) {
+        auto it = g_extInflight.find(INFLIGHT_KEY(id, params.m_msduHandle));
+        if (it == g_extInflight.end()) {
+            return; // broadcast
+        }
+        dst_id = it->second;
+        g_extInflight.erase(it);
+    } else {
+        dst_id = addr2id(params.m_addrShortDstAddr);
+    }
+    if(dst_id == CL_BCAST_ID) {
         return;
     }
 #if 0
@@ -95,7 +140,7 @@ static void DataConfirm (int id, McpsDataConfirmParams params)
 static void DataIndication (int id, McpsDataIndicationParams params,
                             Ptr<Packet> p)
 {
-    DEFINE_MBUF(mbuf);
+    POOL_MBUF(mbuf);
 
     if (p->GetSize() >= COMMLINE_MAX_BUF) {
         CERROR << "Pkt len" << p->GetSize() << " bigger than\n";
@@ -103,13 +148,23 @@ static void DataIndication (int id, McpsDataIndicationParams params,
     }
 
     mbuf->len           = p->CopyData(mbuf->buf, COMMLINE_MAX_BUF);
-    mbuf->src_id        = addr2id(params.m_srcAddr);
-    mbuf->dst_id        = addr2id(params.m_dstAddr);
+    wf::MbufPool::copied(mbuf->len);
+    wf::PktTrace::unpark(p->GetUid(), id, mbuf);
+    if (params.m_srcAddrMode == EXT_ADDR) {
+        mbuf->src_id    = extAddr2id(params.m_srcExtAddr);
+    } else {
+        mbuf->src_id    = addr2id(params.m_srcAddr);
+    }
+    if (params.m_dstAddrMode == EXT_ADDR) {
+        mbuf->dst_id    = extAddr2id(params.m_dstExtAddr);
+    } else {
+        mbuf->dst_id    = addr2id(params.m_dstAddr);
+    }
     mbuf->info.sig.lqi  = params.m_mpduLinkQuality;
     SendPacketToStackline(id, mbuf);
 }
 
-static void setShortAddress(Ptr<LrWpanNetDevice> dev, uint16_t id)
+static void setShortAddress(Ptr<LrWpanNetDevice> dev, cl_nodeid_t id)
 {
     Mac16Address address;
     uint8_t idBuf[2];
@@ -120,38 +175,69 @@ static void setShortAddress(Ptr<LrWpanNetDevice> dev, uint16_t id)
     dev->GetMac()->SetShortAddress (address);
 };
 
-static int setAllNodesParam(NodeContainer & nodes)
+/*
+ * One spectrum channel object per 802.15.4 channel so that a transmission
+ * is fanned out only to the phys tuned to that channel. The channel objects
+ * share the propagation models. Channel 11 stays on the lr-wpan helper's
+ * default channel if no loss/delay model is configured.
+ */
+#define LRWPAN_MIN_CHANNEL 11
+#define LRWPAN_MAX_CHANNEL 26
+
+static map<int, Ptr<SpectrumChannel> > g_channels;
+static Ptr<PropagationLossModel> g_plm;
+static Ptr<PropagationDelayModel> g_pdm;
+static vector<uint8_t> g_nodeChan;
+static vector<double> g_txPower;
+
+static Ptr<SpectrumChannel> getChannel(int ch)
 {
     Ptr<SingleModelSpectrumChannel> channel;
+    auto it = g_channels.find(ch);
+
+    if (it != g_channels.end()) {
+        return it->second;
+    }
+    channel = CreateObject<SingleModelSpectrumChannel> ();
+    if (!channel) {
+        return NULL;
+    }
+    if (g_plm) {
+        channel->AddPropagationLossModel(g_plm);
+    }
+    if (g_pdm) {
+        channel->SetPropagationDelayModel(g_pdm);
+    }
+    g_channels[ch] = channel;
+    return channel;
+}
+
+static int setAllNodesParam(NodeContainer & nodes)
+{
     string loss_model = CFG("lossModel");
     string del_model = CFG("delayModel");
     bool macAdd = CFG_INT("macHeaderAdd", 1);
-    LrWpanSpectrumValueHelper svh;
+    bool customChannel = !loss_model.empty() || !del_model.empty();
 
-    if (!loss_model.empty() || !del_model.empty()) {
-        channel = CreateObject<SingleModelSpectrumChannel> ();
-        if (!channel) {
+    if (!loss_model.empty()) {
+        g_plm = getLossModel(loss_model, CFG("lossModelParam"));
+        if (!g_plm) {
             return FAILURE;
         }
-        if (!loss_model.empty()) {
-            static Ptr <PropagationLossModel> plm;
-            string loss_model_param = CFG("lossModelParam");
-            plm = getLossModel(loss_model, loss_model_param);
-            if (!plm) {
-                return FAILURE;
-            }
-            channel->AddPropagationLossModel(plm);
-        }
-        if (!del_model.empty()) {
-            static Ptr <PropagationDelayModel> pdm;
-            string del_model_param = CFG("delayModelParam");
-            pdm = getDelayModel(del_model, del_model_param);
-            if (!pdm) {
-                return FAILURE;
-            }
-            channel->SetPropagationDelayModel(pdm);
+    }
+    if (!del_model.empty()) {
+        g_pdm = getDelayModel(del_model, CFG("delayModelParam"));
+        if (!g_pdm) {
+            return FAILURE;
         }
     }
+    if (!customChannel) {
+        /* Same models as the lr-wpan helper's default channel */
+        g_plm = CreateObject<LogDistancePropagationLossModel> ();
+        g_pdm = CreateObject<ConstantSpeedPropagationDelayModel> ();
+        g_channels[LRWPAN_MIN_CHANNEL] = DynamicCast<SpectrumChannel>(
+                nodes.Get(0)->GetDevice(0)->GetChannel());
+    }
 
 	for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i) 
 	{ 
@@ -168,7 +254,11 @@ static int setAllNodesParam(NodeContainer & nodes)
                 MakeBoundCallback(DataConfirm, node->GetId()));
 		dev->GetMac()->SetMcpsDataIndicationCallback(
                 MakeBoundCallback (DataIndication, node->GetId()));
-        setShortAddress(dev, (uint16_t)node->GetId());
+        if (g_useExtAddr) {
+            dev->GetMac()->SetExtendedAddress(id2extAddr(node->GetId()));
+        } else {
+            setShortAddress(dev, node->GetId());
+        }
 
         if(!macAdd) {
             dev->GetMac()->SetMacHeaderAdd(macAdd);
@@ -178,16 +268,53 @@ static int setAllNodesParam(NodeContainer & nodes)
             //headers are transmitted as is to the stackline on reception
             //dev->GetMac()->SetPromiscuousMode(1);
         }
-        if (!loss_model.empty() || !del_model.empty()) {
-            dev->SetChannel (channel);
+        if (customChannel) {
+            dev->SetChannel (getChannel(LRWPAN_MIN_CHANNEL));
         }
 	}
     return SUCCESS;
 }
 
+/* The MAC adds its header to the packet handed to McpsDataRequest, so the
+ * PHY sees the same uid. Fires for every retry. */
+static void lrwpanPhyTxBegin(Ptr<const Packet> p)
+{
+    wf::PktTrace::macTx(p->GetUid());
+}
+
+/* With the radio off the PHY is in TRX_OFF and drops the frames before the
+ * MAC, so the frames addressed to the node are counted as missed here. */
+static void lrwpanPhyRxDrop(int id, Ptr<const Packet> p)
+{
+    wf::Nodeinfo *ni = WF_config.get_node_info(id);
+    LrWpanMacHeader hdr;
+    bool isDst;
+
+    if (!ni || !ni->isRadioOff() || !p->PeekHeader(hdr) ||
+        !hdr.IsData()) {
+        return;
+    }
+    if (hdr.GetDstAddrMode() == EXT_ADDR) {
+        isDst = extAddr2id(hdr.GetExtDstAddr()) == (cl_nodeid_t)id;
+    } else {
+        cl_nodeid_t dst = addr2id(hdr.GetShortDstAddr());
+        isDst = dst == CL_BCAST_ID || dst == (cl_nodeid_t)id;
+    }
+    if (isDst || ni->getPromisMode()) {
+        wf::Macstats::set_rx_missed(id);
+    }
+}
+
 static int lrwpanSetup(ifaceCtx_t *ctx)
 {
     INFO("setting up lrwpan\n");
+    g_useExtAddr = CFG_INT("macExtAddr", 0) || ctx->nodes.GetN() > 0xfffd;
+    g_msduHandle.resize(ctx->nodes.GetN());
+    g_nodeChan.resize(ctx->nodes.GetN(), LRWPAN_MIN_CHANNEL);
+    g_txPower.resize(ctx->nodes.GetN(), NAN);
+    if (g_useExtAddr) {
+        INFO("Using extended MAC addresses\n");
+    }
     static LrWpanHelper lrWpanHelper;
     static NetDeviceContainer devContainer = lrWpanHelper.Install(ctx->nodes);
     lrWpanHelper.AssociateToPan (devContainer, CFG_PANID);
@@ -199,6 +326,20 @@ static int lrwpanSetup(ifaceCtx_t *ctx)
         lrWpanHelper.EnablePcapAll (ns3_capfile, false /*promiscuous*/);
     }
     setAllNodesParam(ctx->nodes);
+    for (uint32_t i = 0; i < devContainer.GetN(); i++) {
+        Ptr<LrWpanNetDevice> dev = devContainer.Get(i)->GetObject<LrWpanNetDevice>();
+
+        dev->GetPhy()->TraceConnectWithoutContext("PhyRxDrop",
+                MakeBoundCallback(&lrwpanPhyRxDrop, (int)ctx->nodes.Get(i)->GetId()));
+    }
+    if (wf::PktTrace::enabled()) {
+        for (uint32_t i = 0; i < devContainer.GetN(); i++) {
+            Ptr<LrWpanNetDevice> dev = devContainer.Get(i)->GetObject<LrWpanNetDevice>();
+
+            dev->GetPhy()->TraceConnectWithoutContext("PhyTxBegin",
+                                                      MakeCallback(&lrwpanPhyTxBegin));
+        }
+    }
     return SUCCESS;
 }
 
@@ -206,7 +347,7 @@ static int lrwpanSetTxPower(ifaceCtx_t *ctx, int id, double txpow)
 {
     Ptr<LrWpanNetDevice> dev = getDev(ctx, id);
     LrWpanSpectrumValueHelper svh;
-    Ptr<SpectrumValue> psd = svh.CreateTxPowerSpectralDensity (txpow, 11);
+    Ptr<SpectrumValue> psd = svh.CreateTxPowerSpectralDensity (txpow, g_nodeChan[id]);
 
     if (!dev || !psd) {
         CERROR << "set tx power failed for lrwpan\n";
@@ -214,6 +355,42 @@ static int lrwpanSetTxPower(ifaceCtx_t *ctx, int id, double txpow)
     }
     INFO("Node:%d txpower:%f\n", id, txpow);
     dev->GetPhy()->SetTxPowerSpectralDensity(psd);
+    g_txPower[id] = txpow;
+    return SUCCESS;
+}
+
+static int lrwpanSetChannel(ifaceCtx_t *ctx, int id, int ch)
+{
+    Ptr<LrWpanNetDevice> dev = getDev(ctx, id);
+    Ptr<SpectrumChannel> channel;
+    LrWpanPhyPibAttributes attr;
+
+    if (ch < LRWPAN_MIN_CHANNEL || ch > LRWPAN_MAX_CHANNEL) {
+        CERROR << "invalid lrwpan channel " << ch << "\n";
+        return FAILURE;
+    }
+    channel = getChannel(ch);
+    if (!dev || !channel) {
+        CERROR << "set channel failed for lrwpan\n";
+        return FAILURE;
+    }
+    if (dev->GetChannel() != channel) {
+        /* SetChannel() only adds the phy to the new channel's receivers */
+        Ptr<SpectrumChannel> old = DynamicCast<SpectrumChannel>(dev->GetChannel());
+        if (old) {
+            old->RemoveRx(dev->GetPhy());
+        }
+        dev->SetChannel(channel);
+    }
+    attr.phyCurrentChannel = ch;
+    dev->GetPhy()->PlmeSetAttributeRequest(phyCurrentChannel, &attr);
+    g_nodeChan[id] = ch;
+    INFO("Node:%d channel:%d\n", id, ch);
+
+    /* Setting the channel resets tx psd to the nominal power */
+    if (!std::isnan(g_txPower[id])) {
+        return lrwpanSetTxPower(ctx, id, g_txPower[id]);
+    }
     return SUCCESS;
 }
 
@@ -246,16 +423,32 @@ static int lrwpanSetAddress(ifaceCtx_t *ctx, int id, const char *buf, int sz)
     return SUCCESS;
 }
 
+/* With RxOnWhenIdle off, the MAC keeps the PHY in TRX_OFF except while
+ * transmitting/waiting for ACK, so the PHY drops the frames early and no
+ * ACK is sent for them. */
+static int lrwpanSetRadio(ifaceCtx_t *ctx, int id, int on)
+{
+    Ptr<LrWpanNetDevice> dev = getDev(ctx, id);
+
+    if (!dev) {
+        CERROR << "get dev failed for lrwpan\n";
+        return FAILURE;
+    }
+    dev->GetMac()->SetRxOnWhenIdle(on);
+    return SUCCESS;
+}
+
 static void lrwpanCleanup(ifaceCtx_t *ctx)
 {
 }
 
-static Mac16Address id2addr(const uint16_t id)
+static Mac16Address id2addr(const cl_nodeid_t id)
 {
     Mac16Address mac;
-    uint8_t idstr[2], *ptr=(uint8_t*)&id;
-    idstr[1] = ptr[0];
-    idstr[0] = ptr[1];
+    uint8_t idstr[2];
+
+    idstr[0] = (id >> 8) & 0xff;
+    idstr[1] = id & 0xff;
     mac.CopyFrom(idstr);
     return mac;
 };
@@ -278,18 +471,31 @@ static int lrwpanSendPacket(ifaceCtx_t *ctx, int id, msg_buf_t *mbuf)
     }
 
     p0 = Create<Packet> (mbuf->buf, (uint32_t)mbuf->len);
+    wf::PktTrace::park(p0->GetUid(), mbuf);
     params.m_srcAddrMode = SHORT_ADDR;
     params.m_dstAddrMode = SHORT_ADDR;
     params.m_dstPanId    = CFG_PANID;
     params.m_dstAddr     = id2addr(mbuf->dst_id);
     params.m_msduHandle  = 0;
     params.m_txOptions   = TX_OPTION_NONE;
-    if(mbuf->dst_id != 0xffff) {
+    if(mbuf->dst_id != CL_BCAST_ID) {
         params.m_txOptions = TX_OPTION_ACK;
     }
+    if (g_useExtAddr) {
+        params.m_srcAddrMode = EXT_ADDR;
+        if (mbuf->dst_id != CL_BCAST_ID) {
+            params.m_dstAddrMode = EXT_ADDR;
+            params.m_dstExtAddr  = id2extAddr(mbuf->dst_id);
+            if (!++g_msduHandle[id]) {
+                g_msduHandle[id] = 1; // 0 is the handle of the bcast frames
+            }
+            params.m_msduHandle  = g_msduHandle[id];
+            g_extInflight[INFLIGHT_KEY(id, params.m_msduHandle)] = mbuf->dst_id;
+        }
+    }
 
     // If the src node is in promiscuous mode then disable L2-ACK 
-    if(IN_RANGE(mbuf->src_id, 0, numNodes)) {
+    if(mbuf->src_id < (cl_nodeid_t)numNodes) {
         wf::Nodeinfo *ni=NULL;
         ni = WF_config.get_node_info(mbuf->src_id);
         if(ni && ni->getPromisMode()) {
@@ -316,6 +522,9 @@ ifaceApi_t lrwpanIface = {
     setPromiscuous : lrwpanSetPromiscuous,
     setAddress     : lrwpanSetAddress,
     sendPacket     : lrwpanSendPacket,
+    nodeMoved      : NULL,
+    setChannel     : lrwpanSetChannel,
+    setRadio       : lrwpanSetRadio,
     cleanup        : lrwpanCleanup,
 };
 
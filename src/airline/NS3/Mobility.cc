@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Mobility Models from NS3 for Whitefield
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define	_MOBILITY_CC_
+
+#include <map>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include <ns3/mobility-module.h>
+
+#include "common.h"
+#include "Nodeinfo.h"
+#include "Config.h"
+#include "Mobility.h"
+
+static string getSpeedVar(map<string, string, ci_less> & m)
+{
+    string minspeed = getMapCfg(m, "minSpeed");
+    string maxspeed = getMapCfg(m, "maxSpeed");
+
+    if (minspeed.empty()) minspeed = "0.3";
+    if (maxspeed.empty()) maxspeed = "0.7";
+    return "ns3::UniformRandomVariable[Min=" + minspeed + "|Max=" + maxspeed + "]";
+}
+
+static int setRandomWaypointMM(MobilityHelper & mob, map<string, string, ci_less> & m)
+{
+    ObjectFactory wpAlloc;
+    string pause = getMapCfg(m, "pause");
+
+    if (pause.empty()) pause = "2";
+
+    /* Waypoints are chosen within the configured field */
+    wpAlloc.SetTypeId("ns3::RandomRectanglePositionAllocator");
+    wpAlloc.Set("X", StringValue("ns3::UniformRandomVariable[Min=0.0|Max="
+                + CFG("fieldX") + "]"));
+    wpAlloc.Set("Y", StringValue("ns3::UniformRandomVariable[Min=0.0|Max="
+                + CFG("fieldY") + "]"));
+    Ptr<PositionAllocator> alloc = wpAlloc.Create()->GetObject<PositionAllocator>();
+
+    mob.SetMobilityModel("ns3::RandomWaypointMobilityModel",
+            "Speed", StringValue(getSpeedVar(m)),
+            "Pause", StringValue("ns3::ConstantRandomVariable[Constant=" + pause + "]"),
+            "PositionAllocator", PointerValue(alloc));
+    return SUCCESS;
+}
+
+static int setRandomWalkMM(MobilityHelper & mob, map<string, string, ci_less> & m)
+{
+    string time = getMapCfg(m, "time");
+    string dist = getMapCfg(m, "distance");
+    Rectangle bounds(0, stod(CFG("fieldX")), 0, stod(CFG("fieldY")));
+
+    if (!dist.empty()) {
+        mob.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
+                "Bounds", RectangleValue(bounds),
+                "Speed", StringValue(getSpeedVar(m)),
+                "Mode", StringValue("Distance"),
+                "Distance", DoubleValue(stod(dist)));
+        return SUCCESS;
+    }
+    if (time.empty()) time = "1";
+    mob.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
+            "Bounds", RectangleValue(bounds),
+            "Speed", StringValue(getSpeedVar(m)),
+            "Mode", StringValue("Time"),
+            "Time", TimeValue(Seconds(stod(time))));
+    return SUCCESS;
+}
+
+/* Sets the mobility model to be used for subsequent mob.Install() */
+int setMobilityModel(MobilityHelper & mob, string model, string model_param)
+{
+    int ret;
+    auto cfgmap = splitKV(model_param);
+
+    if (model.empty() || stricmp(model, "Constant") == 0) {
+        mob.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+        return SUCCESS;
+    }
+    if (stricmp(model, "RandomWaypoint") == 0) {
+        ret = setRandomWaypointMM(mob, cfgmap);
+    } else if (stricmp(model, "RandomWalk") == 0) {
+        ret = setRandomWalkMM(mob, cfgmap);
+    } else if (stricmp(model, "Ns2Trace") == 0) {
+        /* Ns2MobilityHelper drives an existing ConstantVelocity model */
+        getMapCfg(cfgmap, "file");
+        mob.SetMobilityModel("ns3::ConstantVelocityMobilityModel");
+        ret = SUCCESS;
+    } else {
+        CERROR << "Unknown mobility model [" << model << "]\n";
+        return FAILURE;
+    }
+    if (cfgmap.size() != 0) {
+        map<string, string, ci_less>::iterator i;
+        for (i = cfgmap.begin(); i != cfgmap.end(); ++i) {
+            CERROR << "Unprocessed mobility model param: " 
+                  << i->first << "=" << i->second << "\n";
+        }
+    }
+    return ret;
+}
+
+/*
+ * Plays back an ns-2 movement trace. Node ids in the trace are whitefield
+ * node ids and index into nodes[]. Entries left null are nodes not
+ * configured with this trace; Ns2MobilityHelper skips their movements.
+ */
+int installNs2Trace(vector<Ptr<Node>> & nodes, string model_param)
+{
+    auto cfgmap = splitKV(model_param);
+    string file = getMapCfg(cfgmap, "file");
+
+    if (file.empty()) {
+        CERROR << "Ns2Trace mobility needs mobilityModelParam=file=<path>\n";
+        return FAILURE;
+    }
+    if (access(file.c_str(), R_OK)) {
+        CERROR << "Cannot read ns-2 mobility trace " << file << "\n";
+        return FAILURE;
+    }
+    CINFO << "Using ns-2 mobility trace [" << file << "]\n";
+    Ns2MobilityHelper ns2(file);
+    ns2.Install(nodes.begin(), nodes.end());
+    return SUCCESS;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Mobility Models from NS3 for Whitefield
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _MOBILITY_H_
+#define _MOBILITY_H_
+
+#include <vector>
+
+#include <ns3/node-container.h>
+#include <ns3/mobility-helper.h>
+
+using namespace ns3;
+using namespace std;
+
+int setMobilityModel(MobilityHelper &mob, string model, string model_param);
+int installNs2Trace(vector<Ptr<Node>> &nodes, string model_param);
+
+#endif //	_MOBILITY_H_
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       On-disk cache of the PLC channel transfer functions
+ *
+ * File layout: plcch_hdr_t, then for every connected tx/rx interface pair a
+ * plcch_pair_t followed by nbands complex<double> values. Only time
+ * invariant transfer functions are cached, which is what constant outlet
+ * impedances give.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#if PLC
+#define _PLCCHANNELCACHE_CC_
+
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <PLCChannelCache.h>
+#include <PowerLineCommHandler.h>
+
+#define PLCCH_MAGIC 0x48434c50 // "PLCH"
+#define PLCCH_VER   1
+
+typedef struct __attribute__((packed)) _plcch_hdr_ {
+    uint32_t magic;
+    uint16_t ver;
+    uint16_t rsvd;
+    uint64_t key;
+    uint32_t ntx, nrx, nbands;
+    uint32_t npairs;
+} plcch_hdr_t;
+
+typedef struct __attribute__((packed)) _plcch_pair_ {
+    uint32_t tx, rx;
+} plcch_pair_t;
+
+static uint64_t g_cacheKey = 0xcbf29ce484222325ULL; // FNV-1a 64 offset basis
+
+void plcCacheKeyAdd(const char *fmt, ...)
+{
+    char    buf[256];
+    va_list ap;
+    int     n, i;
+
+    va_start(ap, fmt);
+    n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    n = n < (int)sizeof(buf) ? n : (int)sizeof(buf) - 1;
+    for (i = 0; i <= n; i++) { // the trailing 0 separates the entries
+        g_cacheKey = (g_cacheKey ^ (uint8_t)buf[i]) * 0x100000001b3ULL;
+    }
+}
+
+/* The interface list decides which pairs the vectors belong to, a node that
+ * only transmits or receives changes the pair indices */
+void plcCacheKeyChannel(Ptr<PLC_Channel> channel)
+{
+    uint32_t i;
+
+    for (i = 0; i < channel->GetNTxInterfaces(); i++) {
+        plcCacheKeyAdd("tx %u %s", i, channel->GetTxInterface(i)->GetNode()->GetName().c_str());
+    }
+    for (i = 0; i < channel->GetNRxInterfaces(); i++) {
+        plcCacheKeyAdd("rx %u %s", i, channel->GetRxInterface(i)->GetNode()->GetName().c_str());
+    }
+}
+
+static string plcCachePath(void)
+{
+    string dir = CFG("plc_channel_cache");
+    char   name[32];
+
+    if (dir.empty()) {
+        return "";
+    }
+    snprintf(name, sizeof(name), "/%016lx.plcch", (unsigned long)g_cacheKey);
+    return dir + name;
+}
+
+/* Channel of the tx/rx interface pair, NULL if they are not connected */
+Ptr<PLC_ChannelTransferImpl> plcChannelImpl(Ptr<PLC_Channel> channel, uint32_t tx, uint32_t rx)
+{
+    return channel->GetTxInterface(tx)->GetChannelTransferImpl(PeekPointer(channel->GetRxInterface(rx)));
+}
+
+/* Transfer function of a channel, NULL if it is time variant */
+PLC_ValueSpectrum *plcChannelValues(Ptr<PLC_ChannelTransferImpl> impl)
+{
+    Ptr<PLC_TransferVector> tv = DynamicCast<PLC_TransferVector>(impl->GetChannelTransferVector());
+
+    return tv ? &tv->GetValuesRef() : NULL;
+}
+
+static PLC_ValueSpectrum *plcPairValues(Ptr<PLC_Channel> channel, uint32_t tx, uint32_t rx,
+                                        bool &connected)
+{
+    Ptr<PLC_ChannelTransferImpl> impl = plcChannelImpl(channel, tx, rx);
+
+    connected = false;
+    if (!impl) {
+        return NULL;
+    }
+    connected = true;
+    return plcChannelValues(impl);
+}
+
+int plcCacheLoad(Ptr<PLC_Channel> channel)
+{
+    string             path = plcCachePath();
+    plcch_hdr_t        hdr;
+    plcch_pair_t       pair;
+    PLC_ValueSpectrum *val;
+    uint32_t           i, nbands = plcGetSpectrumModel()->GetNumBands();
+    bool               connected;
+    FILE *             fp;
+
+    if (path.empty() || !(fp = fopen(path.c_str(), "r"))) {
+        return FAILURE;
+    }
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != PLCCH_MAGIC ||
+        hdr.ver != PLCCH_VER || hdr.key != g_cacheKey ||
+        hdr.ntx != channel->GetNTxInterfaces() || hdr.nrx != channel->GetNRxInterfaces() ||
+        hdr.nbands != nbands) {
+        CINFO << "PLC channel cache " << path << " does not match, recomputing\n";
+        fclose(fp);
+        return FAILURE;
+    }
+    for (i = 0; i < hdr.npairs; i++) {
+        if (fread(&pair, sizeof(pair), 1, fp) != 1 || pair.tx >= hdr.ntx || pair.rx >= hdr.nrx) {
+            break;
+        }
+        val = plcPairValues(channel, pair.tx, pair.rx, connected);
+        if (!val || val->size() != nbands ||
+            fread(val->data(), sizeof(PLC_Value), nbands, fp) != nbands) {
+            break;
+        }
+    }
+    fclose(fp);
+    if (i < hdr.npairs) {
+        // the vectors loaded so far are overwritten by the computation
+        CERROR << "PLC channel cache " << path << " unusable, recomputing\n";
+        return FAILURE;
+    }
+    CINFO << "PLC channel transfer functions of " << hdr.npairs << " pairs loaded from "
+          << path << "\n";
+    return SUCCESS;
+}
+
+void plcCacheStore(Ptr<PLC_Channel> channel)
+{
+    string             path = plcCachePath(), tmp;
+    plcch_hdr_t        hdr  = { PLCCH_MAGIC, PLCCH_VER, 0, g_cacheKey };
+    plcch_pair_t       pair;
+    PLC_ValueSpectrum *val;
+    bool               connected, ok = true;
+    FILE *             fp;
+
+    if (path.empty()) {
+        return;
+    }
+    mkdir(CFG("plc_channel_cache").c_str(), 0755);
+    tmp = path + ".tmp";
+    if (!(fp = fopen(tmp.c_str(), "w"))) {
+        CERROR << "could not write PLC channel cache " << tmp << "\n";
+        return;
+    }
+    hdr.ntx    = channel->GetNTxInterfaces();
+    hdr.nrx    = channel->GetNRxInterfaces();
+    hdr.nbands = plcGetSpectrumModel()->GetNumBands();
+    hdr.npairs = 0;
+    fwrite(&hdr, sizeof(hdr), 1, fp); // rewritten with npairs at the end
+    for (pair.tx = 0; ok && pair.tx < hdr.ntx; pair.tx++) {
+        for (pair.rx = 0; ok && pair.rx < hdr.nrx; pair.rx++) {
+            val = plcPairValues(channel, pair.tx, pair.rx, connected);
+            if (!connected) {
+                continue;
+            }
+            if (!val || val->size() != hdr.nbands) {
+                ok = false; // time variant, not cached
+                break;
+            }
+            fwrite(&pair, sizeof(pair), 1, fp);
+            fwrite(val->data(), sizeof(PLC_Value), hdr.nbands, fp);
+            hdr.npairs++;
+        }
+    }
+    rewind(fp);
+    fwrite(&hdr, sizeof(hdr), 1, fp);
+    if (fclose(fp) || !ok || rename(tmp.c_str(), path.c_str())) {
+        if (ok) {
+            CERROR << "could not write PLC channel cache " << path << "\n";
+        }
+        unlink(tmp.c_str());
+        return;
+    }
+    CINFO << "PLC channel transfer functions of " << hdr.npairs << " pairs cached in "
+          << path << "\n";
+}
+
+#endif // PLC
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       On-disk cache of the PLC channel transfer functions
+ *
+ * Everything that goes into the transfer functions (spectrum model, node
+ * positions, outlet impedances, cables and the ordered tx/rx interface
+ * nodes) is added to the cache key while the PLC graph is built. With plc_channel_cache=<dir> the computed transfer
+ * functions are stored in <dir>/<key>.plcch and loaded instead of being
+ * computed again on the next start with the same key.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _PLCCHANNELCACHE_H_
+#define _PLCCHANNELCACHE_H_
+
+#include <common.h>
+
+#include <ns3/plc.h>
+
+using namespace ns3;
+
+void plcCacheKeyAdd(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void plcCacheKeyChannel(Ptr<PLC_Channel> channel);
+int  plcCacheLoad(Ptr<PLC_Channel> channel);
+void plcCacheStore(Ptr<PLC_Channel> channel);
+
+Ptr<PLC_ChannelTransferImpl> plcChannelImpl(Ptr<PLC_Channel> channel, uint32_t tx, uint32_t rx);
+PLC_ValueSpectrum *          plcChannelValues(Ptr<PLC_ChannelTransferImpl> impl);
+
+#endif //  _PLCCHANNELCACHE_H_
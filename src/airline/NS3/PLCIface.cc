@@ -25,6 +25,7 @@
 #include <Config.h>
 #include <IfaceHandler.h>
 #include <PowerLineCommHandler.h>
+#include <PktTrace.h>
 
 static int plcSetup(ifaceCtx_t *ctx)
 {
@@ -42,7 +43,7 @@ static int plcSetAddress(ifaceCtx_t *ctx, int id, const char *buf, int sz)
     if (sz == 6) {
         addr.CopyFrom((const uint8_t *)buf);
 //    } else if(sz == 2) {
-//        addr = getMacAddress((uint16_t)id);
+//        addr = getMacAddress((cl_nodeid_t)id);
     } else {
         CERROR << "PLC Invalid address size=" << sz << "\n";
         return FAILURE;
@@ -58,6 +59,7 @@ static int plcSendPacket(ifaceCtx_t *ctx, int id, msg_buf_t *mbuf)
     Mac48Address dst;
 
     pkt = Create<Packet> (mbuf->buf, (uint32_t)mbuf->len);
+    wf::PktTrace::park(pkt->GetUid(), mbuf);
     dst = getMacAddress(mbuf->dst_id);
 
     INFO("Sending PLC pkt id=%d dst=%d len=%d\n",
@@ -76,6 +78,9 @@ ifaceApi_t plcIface = {
     setPromiscuous : NULL,
     setAddress     : plcSetAddress,
     sendPacket     : plcSendPacket,
+    nodeMoved      : NULL,
+    setChannel     : NULL,
+    setRadio       : NULL,
     cleanup        : plcCleanup,
 };
 
@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       PLC grid topology file loader (plc_topology_file=)
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#if PLC
+#define _PLCTOPOLOGYFILE_CC_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <PLCTopologyFile.h>
+
+#define PLC_TOPO_RDBUF_SZ (1 << 20)
+#define PLC_TOPO_DEF_CABLE "NAYY150SE"
+
+typedef struct _plc_topo_parser_ {
+    plc_topo_t &       topo;
+    uint32_t           numNodes;
+    vector<uint8_t>    nodeSet;
+    map<uint32_t, uint32_t> junctionIdx; // jid to index in topo.junctions
+    map<string, uint32_t> cableIdx;
+} plc_topo_parser_t;
+
+/* Returns ptr to the next field or NULL if line ended */
+static char *nextField(char *p)
+{
+    while (*p && *p != ',') p++;
+    if (!*p) return NULL;
+    p++;
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+static size_t fieldLen(const char *p)
+{
+    size_t n = 0;
+
+    while (p[n] && p[n] != ',') n++;
+    while (n && (p[n - 1] == ' ' || p[n - 1] == '\t')) n--;
+    return n;
+}
+
+static bool isRecord(const char *p, const char *type)
+{
+    size_t n = strlen(type);
+
+    return !strncmp(p, type, n) && fieldLen(p) == n;
+}
+
+/* Next field, or the end of the line if there is none */
+static char *skipField(char *p)
+{
+    char *f = nextField(p);
+
+    return f ? f : p + strlen(p);
+}
+
+/* id,x,y[,z] of a node or junction, returns ptr to the field after it */
+static char *parsePos(char *p, wf_posrec_t &rec)
+{
+    char *end;
+
+    rec.id = strtoul(p, &end, 0);
+    if (end == p || fieldLen(end) || !(p = nextField(end))) return NULL;
+    rec.x = strtod(p, &end);
+    if (end == p || fieldLen(end) || !(p = nextField(end))) return NULL;
+    rec.y = strtod(p, &end);
+    if (end == p || fieldLen(end)) return NULL;
+    rec.z = 0;
+    p     = skipField(end);
+    if (*p && !memchr(p, '=', fieldLen(p))) {
+        rec.z = strtod(p, &end);
+        if (end == p || fieldLen(end)) return NULL;
+        p = skipField(end);
+    }
+    return p;
+}
+
+/* <id> or j<jid>, encoded as in plc_topo_line_t */
+static int parseEnd(plc_topo_parser_t &ps, char *p, uint32_t &id)
+{
+    bool  junction = (*p == 'j');
+    char *end;
+
+    if (junction) p++;
+    id = strtoul(p, &end, 0);
+    if (end == p || fieldLen(end)) return FAILURE;
+    if (junction) {
+        if (id >= PLC_TOPO_JUNCTION) return FAILURE;
+        id |= PLC_TOPO_JUNCTION; // jid, mapped once all junctions are read
+    } else if (id >= ps.numNodes) {
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/* Line end jid to its index in topo.junctions */
+static int mapJunction(plc_topo_parser_t &ps, uint32_t &end)
+{
+    if (!(end & PLC_TOPO_JUNCTION)) return SUCCESS;
+    auto it = ps.junctionIdx.find(end & ~PLC_TOPO_JUNCTION);
+    if (it == ps.junctionIdx.end()) {
+        ERROR("plc_topology_file junction j%u not defined\n", end & ~PLC_TOPO_JUNCTION);
+        return FAILURE;
+    }
+    end = PLC_TOPO_JUNCTION | it->second;
+    return SUCCESS;
+}
+
+static int parseLine(plc_topo_parser_t &ps, char *line, long lineno)
+{
+    plc_topo_t &    topo = ps.topo;
+    wf_posrec_t     rec;
+    plc_topo_line_t ln;
+    char *          p = line, *f, *eq;
+
+    while (*p == ' ' || *p == '\t') p++;
+    if (!*p || *p == '#') return SUCCESS;
+    if (!(f = nextField(p))) goto invalid;
+
+    if (isRecord(p, "node")) {
+        if (!(p = parsePos(f, rec))) goto invalid;
+        if (rec.id >= ps.numNodes || ps.nodeSet[rec.id]) {
+            ERROR("plc_topology_file line %ld: node %u out of range or repeated\n", lineno, rec.id);
+            return FAILURE;
+        }
+        ps.nodeSet[rec.id] = 1;
+        topo.nodes.push_back(rec);
+        for (; *p; p = skipField(p)) {
+            size_t n = fieldLen(p);
+
+            if (!(eq = (char *)memchr(p, '=', n))) goto invalid;
+            string key(p, eq - p), val(eq + 1, p + n - eq - 1);
+            topo.attrs.push_back({ rec.id, trim(key), trim(val) });
+        }
+    } else if (isRecord(p, "junction")) {
+        if (!(p = parsePos(f, rec)) || *p) goto invalid;
+        if (rec.id >= PLC_TOPO_JUNCTION) goto invalid;
+        if (!ps.junctionIdx.insert(make_pair(rec.id, topo.junctions.size())).second) {
+            ERROR("plc_topology_file line %ld: junction %u repeated\n", lineno, rec.id);
+            return FAILURE;
+        }
+        topo.junctions.push_back(rec);
+    } else if (isRecord(p, "line")) {
+        if (parseEnd(ps, f, ln.from) != SUCCESS || !(f = nextField(f)) ||
+            parseEnd(ps, f, ln.to) != SUCCESS || ln.from == ln.to) {
+            ERROR("plc_topology_file line %ld: line ends must be two distinct node ids "
+                  "or j<jid>\n", lineno);
+            return FAILURE;
+        }
+        string cable = PLC_TOPO_DEF_CABLE;
+        if ((f = nextField(f)) && fieldLen(f)) {
+            cable = string(f, fieldLen(f));
+            if (nextField(f)) goto invalid;
+        }
+        auto it = ps.cableIdx.find(cable);
+        if (it == ps.cableIdx.end()) {
+            it = ps.cableIdx.insert(make_pair(cable, topo.cables.size())).first;
+            topo.cables.push_back(cable);
+        }
+        ln.cable = it->second;
+        topo.lines.push_back(ln);
+    } else {
+        goto invalid;
+    }
+    return SUCCESS;
+
+invalid:
+    ERROR("plc_topology_file line %ld: expected node,<id>,<x>,<y>[,<z>][,key=value...] "
+          "junction,<jid>,<x>,<y>[,<z>] or line,<end>,<end>[,<cable>]\n", lineno);
+    return FAILURE;
+}
+
+/*
+ * Streams the file in large chunks and parses it in place, the same way as
+ * the topologyFile loader.
+ */
+int plcTopoLoad(const char *path, uint32_t numNodes, plc_topo_t &topo)
+{
+    plc_topo_parser_t ps = { topo, numNodes };
+    char *            buf, *line, *nl, *eol;
+    size_t            len = 0, rd;
+    long              lineno = 0;
+    int               ret    = SUCCESS;
+    FILE *            fp;
+
+    ps.nodeSet.resize(numNodes);
+    fp = fopen(path, "r");
+    if (!fp) {
+        ERROR("could not open plc_topology_file [%s] %m\n", path);
+        return FAILURE;
+    }
+    buf = (char *)malloc(PLC_TOPO_RDBUF_SZ + 1);
+    if (!buf) {
+        ERROR("plc_topology_file read buf alloc failed\n");
+        fclose(fp);
+        return FAILURE;
+    }
+    do {
+        rd = fread(buf + len, 1, PLC_TOPO_RDBUF_SZ - len, fp);
+        len += rd;
+        buf[len] = 0;
+        line     = buf;
+        while ((nl = (char *)memchr(line, '\n', buf + len - line)) || (!rd && line < buf + len)) {
+            eol  = nl ? nl : buf + len;
+            *eol = 0;
+            if (eol > line && eol[-1] == '\r') eol[-1] = 0;
+            if (parseLine(ps, line, ++lineno) != SUCCESS) {
+                ret = FAILURE;
+                goto done;
+            }
+            line = nl ? nl + 1 : eol;
+        }
+        len -= line - buf;
+        if (len >= PLC_TOPO_RDBUF_SZ) {
+            ERROR("plc_topology_file line %ld too long\n", lineno + 1);
+            ret = FAILURE;
+            goto done;
+        }
+        memmove(buf, line, len);
+    } while (rd);
+    if (topo.nodes.size() != numNodes) {
+        ERROR("plc_topology_file has %zu of %u nodes, every node needs a position\n",
+              topo.nodes.size(), numNodes);
+        ret = FAILURE;
+    }
+    for (size_t i = 0; ret == SUCCESS && i < topo.lines.size(); i++) {
+        if (mapJunction(ps, topo.lines[i].from) != SUCCESS ||
+            mapJunction(ps, topo.lines[i].to) != SUCCESS) {
+            ret = FAILURE;
+        }
+    }
+done:
+    free(buf);
+    fclose(fp);
+    return ret;
+}
+
+#endif // PLC
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       PLC grid topology file loader (plc_topology_file=)
+ *
+ * One record per line, positions in meters:
+ *     node,<id>,<x>,<y>[,<z>][,key=value...]
+ *     junction,<jid>,<x>,<y>[,<z>]
+ *     line,<end>,<end>[,<cable>]
+ * A node is a stackline with an outlet and a PLC interface. A junction is a
+ * point of the grid without an outlet, such as a cable joint, a bend or a
+ * distribution cabinet. A line end is a node id or j<jid>. A line is a cable
+ * segment whose length is the distance between its ends, so bends of a
+ * feeder are given as junctions. The key=value attributes are applied as
+ * key[id]=value, e.g. plc_outlet_impedance=50.5. Lines starting with '#'
+ * are ignored.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _PLCTOPOLOGYFILE_H_
+#define _PLCTOPOLOGYFILE_H_
+
+#include <TopologyFile.h>
+
+#define PLC_TOPO_JUNCTION 0x80000000 // line end is a junction
+
+typedef struct _plc_topo_line_ {
+    uint32_t from, to; // node id, or PLC_TOPO_JUNCTION | index in junctions
+    uint32_t cable; // index in plc_topo_t::cables
+} plc_topo_line_t;
+
+typedef struct _plc_topo_ {
+    vector<wf_posrec_t>     nodes;
+    vector<wf_posrec_t>     junctions; // id is the jid
+    vector<wf_topoattr_t>   attrs;
+    vector<plc_topo_line_t> lines;
+    vector<string>          cables;
+} plc_topo_t;
+
+int plcTopoLoad(const char *path, uint32_t numNodes, plc_topo_t &topo);
+
+#endif //  _PLCTOPOLOGYFILE_H_
@@ -21,6 +21,10 @@
 #define	_POWERLINECOMMHANDLER_CC_
 
 #include <arpa/inet.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <ns3/nstime.h>
 #include <ns3/simulator.h>
@@ -32,6 +36,10 @@
 #include "Config.h"
 #include "PowerLineCommHandler.h"
 #include "IfaceHandler.h"
+#include "MbufPool.h"
+#include "PktTrace.h"
+#include "PLCChannelCache.h"
+#include "PLCTopologyFile.h"
 
 PLC_SpectrumModelHelper g_smHelper;
 PLC_NetdeviceMap g_devMap;
@@ -82,7 +90,7 @@ int plcGetCable(string cableStr, Ptr<PLC_Cable> & cable)
     return SUCCESS;
 }
 
-int plcConnectLink(ifaceCtx_t *ctx, uint16_t i1, uint16_t i2, string cableStr)
+int plcConnectLink(ifaceCtx_t *ctx, cl_nodeid_t i1, cl_nodeid_t i2, string cableStr)
 {
     Ptr<PLC_Node> n1 = ctx->plcNodes[i1];
     Ptr<PLC_Node> n2 = ctx->plcNodes[i2];
@@ -98,11 +106,12 @@ int plcConnectLink(ifaceCtx_t *ctx, uint16_t i1, uint16_t i2, string cableStr)
         ERROR("Cud not get PLC Cable\n");
         return FAILURE;
     }
+    plcCacheKeyAdd("link %d %d %s", i1, i2, cableStr.c_str());
     CreateObject<PLC_Line> (cable, n1, n2);
     return SUCCESS;
 }
 
-int getNodePosition(ifaceCtx_t *ctx, uint16_t id, Vector & pos)
+int getNodePosition(ifaceCtx_t *ctx, cl_nodeid_t id, Vector & pos)
 {
     Ptr<Node> n = ctx->nodes.Get(id);
     Ptr<MobilityModel> mob = n ? n->GetObject<MobilityModel> () : NULL;
@@ -130,27 +139,28 @@ Ptr<SpectrumValue> getTxPsd(void)
     return txPsd;
 }
 
-Mac48Address getMacAddress(uint16_t id)
+Mac48Address getMacAddress(cl_nodeid_t id)
 {
-    uint8_t idbuf[2];
-    char buf[64];
+    uint8_t idbuf[6] = { 0 };
 
-    if (id == 0xffff) {
+    if (id == CL_BCAST_ID) {
         return Mac48Address("ff:ff:ff:ff:ff:ff");
     }
 
-    id = htons(id+1);
-    memcpy(idbuf, &id, 2);
-    snprintf(buf, sizeof(buf), "00:00:00:00:%02x:%02x", *idbuf, *(idbuf+1));
-    return Mac48Address(buf);
+    id = htonl(id+1);
+    memcpy(idbuf + 2, &id, 4);
+    Mac48Address addr;
+    addr.CopyFrom(idbuf);
+    return addr;
 }
 
-int plcAddOutlet(Ptr<PLC_Node> n, uint16_t id)
+int plcAddOutlet(Ptr<PLC_Node> n, cl_nodeid_t id)
 {
     Ptr<PLC_Outlet> outlet;
     string outletimp;
 
     outletimp = WF_config.getNodeCfg(id, "plc_outlet_impedance");
+    plcCacheKeyAdd("outlet %d %s", id, outletimp.c_str());
     if (outletimp.empty()) {
         outlet = CreateObject<PLC_Outlet> (n);
     } else {
@@ -161,7 +171,7 @@ int plcAddOutlet(Ptr<PLC_Node> n, uint16_t id)
     return outlet ? SUCCESS : FAILURE;
 }
 
-int plcAddInterface(Ptr<PLC_Node> n, uint16_t id)
+int plcAddInterface(Ptr<PLC_Node> n, cl_nodeid_t id)
 {
     string intf;
     bool tx = true, rx = true;
@@ -191,7 +201,7 @@ int plcAddInterface(Ptr<PLC_Node> n, uint16_t id)
 /*
  * PLC Node has an outlet which has an interface.
  */
-int plcAddNode(ifaceCtx_t *ctx, uint16_t id)
+int plcAddNode(ifaceCtx_t *ctx, cl_nodeid_t id)
 {
     Vector pos;
     Ptr<PLC_Node> n;
@@ -211,6 +221,7 @@ int plcAddNode(ifaceCtx_t *ctx, uint16_t id)
     INFO("PLC creating node=%d Position=%f,%f,%f\n",
          id, pos.x, pos.y, pos.z);
     n->SetPosition(pos.x, pos.y, pos.z); // convert to cm
+    plcCacheKeyAdd("node %d %.17g %.17g %.17g", id, pos.x, pos.y, pos.z);
     getDevName(id, name, sizeof(name));
     n->SetName(name);
 
@@ -272,6 +283,182 @@ int plcAddChannel(ifaceCtx_t *ctx)
     return SUCCESS;
 }
 
+static int plcChannelJobs(void)
+{
+    cpu_set_t set;
+    int       jobs = CFG_INT("plc_channel_jobs", 0);
+
+    if (jobs > 0) {
+        return jobs;
+    }
+    // the cpus left to the airline by airlineCpuSet
+    if (sched_getaffinity(0, sizeof(set), &set)) {
+        return 1;
+    }
+    return CPU_COUNT(&set);
+}
+
+static long plcMsSince(const struct timespec &t0)
+{
+    struct timespec t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0.tv_sec) * 1000 + (t1.tv_nsec - t0.tv_nsec) / 1000000;
+}
+
+/* Threads of the process, 0 if unknown */
+static int plcThreadCount(void)
+{
+    FILE *fp = fopen("/proc/self/status", "r");
+    char line[128];
+    int n = 0;
+
+    if (!fp) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "Threads: %d", &n) == 1) {
+            break;
+        }
+    }
+    fclose(fp);
+    return n;
+}
+
+/*
+ * plc_channel_verify=1 recomputes every pair serially in the airline after
+ * the workers and compares the transfer functions and whether they are
+ * still time invariant. The serial results are kept, so it only costs time.
+ */
+static int plcVerifyChannels(vector<Ptr<PLC_ChannelTransferImpl> > &impls, size_t nbands)
+{
+    vector<PLC_Value> par(nbands);
+    PLC_ValueSpectrum *val;
+    size_t k, b, bad = 0;
+    double maxerr = 0;
+    bool differs;
+
+    for (k = 0; k < impls.size(); k++) {
+        val = plcChannelValues(impls[k]);
+        memcpy(par.data(), val->data(), nbands * sizeof(PLC_Value));
+        impls[k]->CalculateChannelTransferVector();
+        val = plcChannelValues(impls[k]);
+        if (!val || val->size() != nbands) {
+            bad++;
+            continue;
+        }
+        differs = false;
+        for (b = 0; b < nbands; b++) {
+            if (par[b] != (*val)[b]) {
+                maxerr  = max(maxerr, abs(par[b] - (*val)[b]));
+                differs = true;
+            }
+        }
+        bad += differs;
+    }
+    if (bad) {
+        ERROR("PLC channel verify: %zu of %zu pairs differ from the serial result, "
+              "max err %g\n", bad, impls.size(), maxerr);
+        return FAILURE;
+    }
+    INFO("PLC channel verify: %zu pairs match the serial result\n", impls.size());
+    return SUCCESS;
+}
+
+/*
+ * CalcTransmissionChannels() split across worker processes. NS3 objects are
+ * not thread safe, so every worker computes its share of the tx/rx pairs in
+ * its own copy of the channel and hands the transfer functions back through
+ * shared memory. They are then installed into the channel.
+ * The airline is single threaded till the simulation runs. The workers are
+ * forked only if that still holds, since a lock held by another thread at
+ * fork time would never be released in the worker.
+ */
+static int plcCalcChannels(Ptr<PLC_Channel> channel)
+{
+    vector<Ptr<PLC_ChannelTransferImpl> > impls;
+    vector<pid_t> workers;
+    Ptr<PLC_ChannelTransferImpl> impl;
+    PLC_ValueSpectrum *val;
+    PLC_Value *shm;
+    size_t nbands = plcGetSpectrumModel()->GetNumBands(), k, sz;
+    int jobs = plcChannelJobs(), w, status, failed = 0, threads;
+    struct timespec t0;
+    pid_t pid;
+
+    for (uint32_t tx = 0; tx < channel->GetNTxInterfaces(); tx++) {
+        for (uint32_t rx = 0; rx < channel->GetNRxInterfaces(); rx++) {
+            impl = plcChannelImpl(channel, tx, rx);
+            if (impl) {
+                impls.push_back(impl);
+            }
+        }
+    }
+    jobs = jobs < (int)impls.size() ? jobs : impls.size();
+    if (jobs <= 1) {
+        return FAILURE;
+    }
+    threads = plcThreadCount();
+    if (threads != 1) {
+        INFO("airline has %d threads, not forking PLC channel workers\n", threads);
+        return FAILURE;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    sz  = impls.size() * nbands * sizeof(PLC_Value);
+    shm = (PLC_Value *)mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shm == MAP_FAILED) {
+        ERROR("PLC channel buffer of %zu bytes: %s\n", sz, strerror(errno));
+        return FAILURE;
+    }
+    for (w = 0; w < jobs; w++) {
+        pid = fork();
+        if (pid < 0) {
+            failed++;
+            break;
+        }
+        if (pid) {
+            workers.push_back(pid);
+            continue;
+        }
+        // pairs are interleaved since the path lengths differ
+        for (k = w; k < impls.size(); k += jobs) {
+            impls[k]->CalculateChannelTransferVector();
+            val = plcChannelValues(impls[k]);
+            if (!val || val->size() != nbands) {
+                _exit(1);
+            }
+            memcpy(shm + k * nbands, val->data(), nbands * sizeof(PLC_Value));
+        }
+        _exit(0);
+    }
+    for (pid_t p : workers) { // not wait(), the forker is a child too
+        while ((pid = waitpid(p, &status, 0)) < 0 && errno == EINTR)
+            ;
+        if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) {
+            failed++;
+        }
+    }
+    for (k = 0; !failed && k < impls.size(); k++) {
+        val = plcChannelValues(impls[k]);
+        if (!val || val->size() != nbands) {
+            failed++;
+            break;
+        }
+        memcpy(val->data(), shm + k * nbands, nbands * sizeof(PLC_Value));
+    }
+    munmap(shm, sz);
+    if (failed) {
+        INFO("parallel PLC channel computation failed, computing serially\n");
+        return FAILURE;
+    }
+    INFO("PLC channels of %zu pairs computed by %d workers in %ld ms\n", impls.size(), jobs,
+         plcMsSince(t0));
+    if (CFG_INT("plc_channel_verify", 0)) {
+        plcVerifyChannels(impls, nbands);
+    }
+    return SUCCESS;
+}
+
 int plcInitChannel(void)
 {
     if (!g_channel) {
@@ -279,22 +466,34 @@ int plcInitChannel(void)
         return FAILURE;
     }
     g_channel->InitTransmissionChannels();
-    g_channel->CalcTransmissionChannels();
+    plcCacheKeyChannel(g_channel);
+    if (plcCacheLoad(g_channel) == SUCCESS) {
+        return SUCCESS;
+    }
+    if (plcCalcChannels(g_channel) != SUCCESS) {
+        struct timespec t0;
+
+        // plc_channel_jobs=1 gives the serial baseline to compare with
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        g_channel->CalcTransmissionChannels();
+        INFO("PLC channels computed serially in %ld ms\n", plcMsSince(t0));
+    }
+    plcCacheStore(g_channel);
     return SUCCESS;
 }
 
-static uint16_t getIdFromMacAddr(Mac48Address addr)
+static cl_nodeid_t getIdFromMacAddr(Mac48Address addr)
 {
     uint8_t buf[6];
-    uint16_t id;
+    cl_nodeid_t id;
 
     if (addr.IsBroadcast()) {
-        return 0xffff;
+        return CL_BCAST_ID;
     }
     addr.CopyTo(buf);
-    memcpy(&id, &buf[4], 2);
-    id = ntohs(id) - 1;
-    if (id >= 0xff00) {
+    memcpy(&id, &buf[2], 4);
+    id = ntohl(id) - 1;
+    if (id >= CL_DSTID_MACHDR_PRESENT) {
         CERROR << "Problem parsing ucast addr=" << addr;
         return 0;
     }
@@ -302,32 +501,32 @@ static uint16_t getIdFromMacAddr(Mac48Address addr)
     return id;
 }
 
-void plcHandleAck(uint16_t id, uint32_t retries, Ptr<Packet> p,
+void plcHandleAck(cl_nodeid_t id, uint32_t retries, Ptr<Packet> p,
         Mac48Address snd, Mac48Address rcv)
 {
-    uint16_t dst_id;
+    cl_nodeid_t dst_id;
 
     dst_id = getIdFromMacAddr(rcv);
     INFO("PLC rcvd ACK id=%d dst_id=%d retries=%d\n", id, dst_id, retries);
     SendAckToStackline(id, dst_id, WF_STATUS_ACK_OK, retries+1);
 }
 
-void plcHandleTxFail(uint16_t id, Ptr<const Packet> p,
+void plcHandleTxFail(cl_nodeid_t id, Ptr<const Packet> p,
                 Mac48Address sndr, Mac48Address rcvr)
 {
-    uint16_t dst_id;
+    cl_nodeid_t dst_id;
 
     dst_id = getIdFromMacAddr(rcvr);
     INFO("PLC TX FAILED %d -> %d len:%d\n", id, dst_id, p->GetSize());
     SendAckToStackline(id, dst_id, WF_STATUS_NO_ACK, 0);
 }
 
-void plcHandleData(uint16_t id, Ptr<Packet> pin,
+void plcHandleData(cl_nodeid_t id, Ptr<Packet> pin,
         Mac48Address sndr, Mac48Address rcvr)
 {
     // HACK: I dont know why PLC module adds extra 8 bytes!
     Ptr<Packet> p = pin->CreateFragment(8, pin->GetSize()-8);
-    DEFINE_MBUF(mbuf);
+    POOL_MBUF(mbuf);
 
     if (p->GetSize() >= COMMLINE_MAX_BUF) {
         ERROR("Pkt len=%d bigger than max(%d)\n",
@@ -337,6 +536,8 @@ void plcHandleData(uint16_t id, Ptr<Packet> pin,
     CINFO << "PLC rcvd Mac DATA sndr=" << sndr << " rcvr=" << rcvr << "\n";
 
     mbuf->len           = p->CopyData(mbuf->buf, COMMLINE_MAX_BUF);
+    wf::MbufPool::copied(mbuf->len);
+    wf::PktTrace::unpark(pin->GetUid(), id, mbuf);
     mbuf->src_id        = getIdFromMacAddr(sndr);
     mbuf->dst_id        = getIdFromMacAddr(rcvr);
     mbuf->info.sig.lqi  = 0;
@@ -345,7 +546,7 @@ void plcHandleData(uint16_t id, Ptr<Packet> pin,
     SendPacketToStackline(id, mbuf);
 }
 
-int plcConfigMac(uint16_t id, Ptr<PLC_NetDevice> dev)
+int plcConfigMac(cl_nodeid_t id, Ptr<PLC_NetDevice> dev)
 {
     Ptr<PLC_Mac> mac = dev->GetMac();
 
@@ -396,7 +597,7 @@ Ptr<PLC_NetDevice> getPlcNetDev(void *arg, int id)
 
 int plcConfigAllNodes(ifaceCtx_t *ctx)
 {
-    uint16_t i;
+    cl_nodeid_t i;
     Ptr<PLC_NetDevice> dev;
 
     for (i = 0; i < g_devMap.size(); ++i) {
@@ -423,35 +624,77 @@ void plcEnableLog(void)
     }
 }
 
-int plcInstall(ifaceCtx_t *ctx)
+/*
+ * Positions and per node attributes from plc_topology_file, applied before
+ * the PLC nodes are created from the node positions.
+ */
+static int plcTopoApplyNodes(ifaceCtx_t *ctx, plc_topo_t &topo)
 {
-	int numNodes = stoi(CFG("numOfNodes")), ret;
-    uint16_t i, j;
-    string plc_link, cableStr;
-    Ptr<const SpectrumModel> sm;
-
-    plcEnableLog();
+    Ptr<MobilityModel> mob;
 
-    sm = plcGetSpectrumModel(CFG("plc_spectrum_model"));
-    if (!sm) {
-        ERROR("Get Spectrum model failed\n");
-        return FAILURE;
+    for (auto &r : topo.nodes) {
+        mob = ctx->nodes.Get(r.id)->GetObject<MobilityModel> ();
+        if (!mob) {
+            ERROR("Cudnot get mobmodel at id=%d\n", r.id);
+            return FAILURE;
+        }
+        mob->SetPosition(Vector(r.x, r.y, r.z));
     }
-
-    if (plcAddChannel(ctx) != SUCCESS) {
-        ERROR("plc Add Channel failed\n");
-        return FAILURE;
+    for (auto &a : topo.attrs) {
+        if (WF_config.setNodeCfg(a.id, a.key, a.val) != SUCCESS) {
+            return FAILURE;
+        }
     }
+    return SUCCESS;
+}
 
-    for (i = 0; i < numNodes; i++) {
-        if (plcAddNode(ctx, i) != SUCCESS) {
-            ERROR("PLC Node addition failed\n");
+/* Junctions and cable segments from plc_topology_file */
+static int plcTopoConnect(ifaceCtx_t *ctx, plc_topo_t &topo)
+{
+    vector<Ptr<PLC_Cable> > cables(topo.cables.size());
+    vector<Ptr<PLC_Node> > junctions;
+    Ptr<PLC_Node> n, ends[2];
+    char name[32];
+
+    // one cable object per type, shared by its segments
+    for (size_t i = 0; i < cables.size(); i++) {
+        if (plcGetCable(topo.cables[i], cables[i]) != SUCCESS) {
             return FAILURE;
         }
     }
+    for (auto &j : topo.junctions) {
+        n = CreateObject<PLC_Node> ();
+        n->SetPosition(j.x * 100, j.y * 100, j.z * 100); // convert to cm
+        snprintf(name, sizeof(name), "junction%u", j.id);
+        n->SetName(name);
+        plcCacheKeyAdd("junction %u %.17g %.17g %.17g", j.id, j.x, j.y, j.z);
+        g_plcGraph->AddNode(n);
+        junctions.push_back(n);
+    }
+    for (auto &ln : topo.lines) {
+        uint32_t e[2] = { ln.from, ln.to };
+
+        for (int k = 0; k < 2; k++) {
+            ends[k] = (e[k] & PLC_TOPO_JUNCTION) ? junctions[e[k] & ~PLC_TOPO_JUNCTION]
+                                                  : ctx->plcNodes[e[k]];
+        }
+        plcCacheKeyAdd("line %x %x %s", ln.from, ln.to, topo.cables[ln.cable].c_str());
+        CreateObject<PLC_Line> (cables[ln.cable], ends[0], ends[1]);
+    }
+    INFO("PLC grid of %zu nodes, %zu junctions and %zu cable segments\n",
+         topo.nodes.size(), topo.junctions.size(), topo.lines.size());
+    return SUCCESS;
+}
+
+/* plc_link[i]=j,cable links from the config */
+static int plcConnectCfgLinks(ifaceCtx_t *ctx, int numNodes)
+{
+    cl_nodeid_t i, j;
+    string plc_link;
+    int ret;
 
     for (i = 0; i < numNodes; i++) {
-        plc_link = WF_config.getNodeCfg((uint16_t)i, "plc_link");
+        plc_link = WF_config.getNodeCfg((cl_nodeid_t)i, "plc_link");
         if (plc_link.empty()) {
             continue;
         }
@@ -460,7 +703,7 @@ int plcInstall(ifaceCtx_t *ctx)
             ERROR("Invalid plc_link format\n");
             return FAILURE;
         }
-        j = (uint16_t)stoi(arr.at(0));
+        j = (cl_nodeid_t)stoi(arr.at(0));
         if (!IN_RANGE(j, 0, numNodes)) {
             ERROR("Invalid dst node(%d) in plc_link\n", j);
             return FAILURE;
@@ -472,6 +715,56 @@ int plcInstall(ifaceCtx_t *ctx)
             return FAILURE;
         }
     }
+    return SUCCESS;
+}
+
+int plcInstall(ifaceCtx_t *ctx)
+{
+	int numNodes = stoi(CFG("numOfNodes"));
+    cl_nodeid_t i;
+    string topoFile = CFG("plc_topology_file");
+    Ptr<const SpectrumModel> sm;
+    plc_topo_t topo;
+
+    plcEnableLog();
+
+    sm = plcGetSpectrumModel(CFG("plc_spectrum_model"));
+    if (!sm) {
+        ERROR("Get Spectrum model failed\n");
+        return FAILURE;
+    }
+    for (Bands::const_iterator b = sm->Begin(); b != sm->End(); ++b) {
+        plcCacheKeyAdd("band %.17g %.17g %.17g", b->fl, b->fc, b->fh);
+    }
+
+    if (plcAddChannel(ctx) != SUCCESS) {
+        ERROR("plc Add Channel failed\n");
+        return FAILURE;
+    }
+
+    if (!topoFile.empty()) {
+        if (plcTopoLoad(topoFile.c_str(), numNodes, topo) != SUCCESS ||
+            plcTopoApplyNodes(ctx, topo) != SUCCESS) {
+            ERROR("PLC topology file %s failed\n", topoFile.c_str());
+            return FAILURE;
+        }
+    }
+
+    for (i = 0; i < numNodes; i++) {
+        if (plcAddNode(ctx, i) != SUCCESS) {
+            ERROR("PLC Node addition failed\n");
+            return FAILURE;
+        }
+    }
+
+    if (!topoFile.empty()) {
+        if (plcTopoConnect(ctx, topo) != SUCCESS) {
+            ERROR("PLC grid setup failed\n");
+            return FAILURE;
+        }
+    } else if (plcConnectCfgLinks(ctx, numNodes) != SUCCESS) {
+        return FAILURE;
+    }
 
     static PLC_NetDeviceHelper deviceHelper(sm, getTxPsd(), ctx->plcNodes);
     deviceHelper.SetNoiseFloor(CreateWorstCaseBgNoise(sm)->GetNoisePsd());
@@ -483,7 +776,7 @@ int plcInstall(ifaceCtx_t *ctx)
     return plcConfigAllNodes(ctx);
 }
 
-int plcSend(uint16_t id, Mac48Address dst, Ptr<Packet> pkt)
+int plcSend(cl_nodeid_t id, Mac48Address dst, Ptr<Packet> pkt)
 {
     char name[64];
 
@@ -31,13 +31,14 @@
 
 using namespace ns3;
 
-static inline int getDevName(uint16_t id, char *name, size_t len)
+static inline int getDevName(cl_nodeid_t id, char *name, size_t len)
 {
     return snprintf(name, len, "node%d", id);
 }
 
-int                plcSend(uint16_t id, Mac48Address dst, Ptr<Packet> pkt);
-Mac48Address       getMacAddress(uint16_t id);
+int                plcSend(cl_nodeid_t id, Mac48Address dst, Ptr<Packet> pkt);
+Mac48Address       getMacAddress(cl_nodeid_t id);
 Ptr<PLC_NetDevice> getPlcNetDev(void *ctx, int id);
+Ptr<const SpectrumModel> plcGetSpectrumModel(void);
 
 #endif //  _POWERLINECOMMHANDLER_H_
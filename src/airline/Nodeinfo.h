@@ -27,37 +27,12 @@
 namespace wf {
 class Nodeinfo : public Macstats {
 private:
-    string  nodeExec;
-    string  capFile;
     double  X, Y, Z;
     uint8_t pos_set;
     uint8_t promis_mode;
-
-    map<string, string, ci_less> keyval;
+    uint8_t radio_off;
 
 public:
-    string getkv(string key, string def = std::string())
-    {
-        if (keyval.find(key) == keyval.end())
-            return def;
-        return keyval[key];
-    };
-    void setkv(string key, string val)
-    {
-        keyval[key] = val;
-    };
-    string getNodeExecutable(void)
-    {
-        return nodeExec;
-    };
-    void setNodeExecutable(const string path)
-    {
-        nodeExec = path;
-    };
-    void setNodeCaptureFile(const string path)
-    {
-        capFile = path;
-    };
     void setPromisMode(int val)
     {
         promis_mode = !!val;
@@ -66,6 +41,14 @@ public:
     {
         return promis_mode;
     };
+    void setRadioOff(int val)
+    {
+        radio_off = !!val;
+    };
+    int isRadioOff(void)
+    {
+        return radio_off;
+    };
     void setNodePosition(const double x_pos, const double y_pos, const double z_pos)
     {
         X       = x_pos;
@@ -86,6 +69,7 @@ public:
     {
         pos_set     = 0;
         promis_mode = 0;
+        radio_off   = 0;
     };
 };
 } //namespace wf
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Recording and replay of the frames sent by stacklines
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _PKTRECORD_CC_
+
+#include <time.h>
+
+#include <PktRecord.h>
+#include <Nodeinfo.h>
+#include <Config.h>
+
+namespace wf {
+FILE *   PktRecord::fp;
+uint64_t PktRecord::frames;
+uint64_t PktRecord::bytes;
+bool     PktRecord::replaying;
+uint64_t PktRecord::dropped;
+
+int PktRecord::open(string path, bool replay)
+{
+    wfrec_hdr_t hdr = { WFREC_MAGIC, WFREC_VER, 0, (uint32_t)WF_config.getNumberOfNodes() };
+
+    replaying = replay;
+    if (replay) {
+        CINFO << "replay mode, no stacklines are spawned\n";
+    }
+    if (path.empty()) {
+        return SUCCESS;
+    }
+    fp = fopen(path.c_str(), "w");
+    if (!fp) {
+        CERROR << "could not open recordFile " << path << "\n";
+        return FAILURE;
+    }
+    setvbuf(fp, NULL, _IOFBF, 1 << 20);
+    fwrite(&hdr, sizeof(hdr), 1, fp);
+    CINFO << "recording stackline frames to " << path << "\n";
+    return SUCCESS;
+}
+
+void PktRecord::close(void)
+{
+    if (fp) {
+        fclose(fp);
+        fp = NULL;
+    }
+}
+
+void PktRecord::rx(msg_buf_t *mbuf)
+{
+    struct timespec ts;
+    wfrec_rec_t     rec;
+
+    /* Stackline cmds (cl_set_channel) are sent without expecting a response,
+     * the monitor's wait for one and are not part of the traffic */
+    if (!fp || ((mbuf->flags & MBUF_IS_CMD) && !(mbuf->flags & MBUF_DO_NOT_RESPOND))) {
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    rec.t_us = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    rec.len  = sizeof(msg_buf_t) + mbuf->len;
+    fwrite(&rec, sizeof(rec), 1, fp);
+    fwrite(mbuf, rec.len, 1, fp);
+    frames++;
+    bytes += rec.len;
+}
+
+int PktRecord::get_summary(char *buf, int buflen)
+{
+    int n;
+
+    if (fp) {
+        fflush(fp);
+        n = snprintf(buf, buflen, "RECORD: frames=%lu,bytes=%lu", frames, bytes);
+    } else {
+        n = snprintf(buf, buflen, "RECORD: off");
+    }
+    if (replaying && n < buflen) {
+        n += snprintf(buf + n, buflen - n, "\nREPLAY: tx_dropped=%lu", dropped);
+    }
+    return n;
+}
+} // namespace wf
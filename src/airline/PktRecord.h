@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Recording and replay of the frames sent by stacklines
+ *
+ * With recordFile=<path> every frame given to msgrecvCallback() by a
+ * stackline is written to a file (utils/wfrecord.h), including the ctrl
+ * msgs and the commands stacklines send (cl_set_channel). Commands from the
+ * monitor are not recorded. With replayMode=1 no stacklines are spawned
+ * and the frames the airline would send to stacklines are only counted.
+ * wf_replay then feeds a recording to the airline with its original
+ * timing.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _PKTRECORD_H_
+#define _PKTRECORD_H_
+
+#include <common.h>
+#include "utils/wfrecord.h"
+
+namespace wf {
+class PktRecord {
+private:
+    static FILE *   fp;
+    static uint64_t frames;
+    static uint64_t bytes;
+    static bool     replaying;
+    static uint64_t dropped;
+
+public:
+    static int  open(string path, bool replay);
+    static void close(void);
+    static void rx(msg_buf_t *mbuf);
+    static bool replay(void)
+    {
+        return replaying;
+    };
+    static void txDropped(void)
+    {
+        dropped++;
+    };
+    static int get_summary(char *buf, int buflen);
+};
+} // namespace wf
+
+#endif // _PKTRECORD_H_
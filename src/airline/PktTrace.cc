@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Per frame trace of the time spent in the airline
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _PKTTRACE_CC_
+
+#include <sys/time.h>
+
+#include <PktTrace.h>
+
+#define TRACE_PARK_MAX 4096 // frames in flight in PHYs that convert the mbuf
+
+namespace wf {
+FILE *                       PktTrace::fp;
+uint64_t                     PktTrace::seq;
+uint64_t                     PktTrace::recs;
+map<uint64_t, wftrace_rec_t> PktTrace::parked;
+deque<uint64_t>              PktTrace::parkOrder;
+
+static uint64_t nowUs(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+int PktTrace::open(string path)
+{
+    wftrace_hdr_t hdr = { WFTRACE_MAGIC, WFTRACE_VER, sizeof(wftrace_rec_t) };
+
+    if (path.empty()) {
+        return SUCCESS;
+    }
+    fp = fopen(path.c_str(), "w");
+    if (!fp) {
+        CERROR << "could not open traceFile " << path << "\n";
+        return FAILURE;
+    }
+    setvbuf(fp, NULL, _IOFBF, 1 << 20);
+    fwrite(&hdr, sizeof(hdr), 1, fp);
+    CINFO << "tracing frames to " << path << "\n";
+    return SUCCESS;
+}
+
+void PktTrace::close(void)
+{
+    if (fp) {
+        fclose(fp);
+        fp = NULL;
+    }
+}
+
+/* Airline read a frame from a stackline */
+void PktTrace::rx(msg_buf_t *mbuf)
+{
+    wftrace_rec_t *t;
+
+    mbuf->flags &= ~MBUF_HAS_TRACE;
+    if (!fp || mbuf->len + sizeof(wftrace_rec_t) > COMMLINE_MAX_BUF) {
+        return;
+    }
+    t = trailer(mbuf);
+    memset(t, 0, sizeof(*t));
+    t->id       = ++seq;
+    t->src      = mbuf->src_id;
+    t->t_enq_us = cl_rx_tstamp();
+    t->t_rx_us  = nowUs();
+    mbuf->flags |= MBUF_HAS_TRACE;
+}
+
+void PktTrace::macTx(msg_buf_t *mbuf)
+{
+    wftrace_rec_t *t;
+
+    if (!(mbuf->flags & MBUF_HAS_TRACE)) {
+        return;
+    }
+    t = trailer(mbuf);
+    if (!t->t_mac_us) {
+        t->t_mac_us = nowUs();
+    }
+    t->tries++;
+}
+
+void PktTrace::park(uint64_t key, msg_buf_t *mbuf)
+{
+    if (!(mbuf->flags & MBUF_HAS_TRACE)) {
+        return;
+    }
+    if (parkOrder.size() >= TRACE_PARK_MAX) {
+        parked.erase(parkOrder.front());
+        parkOrder.pop_front();
+    }
+    parked[key]     = *trailer(mbuf);
+    parked[key].dst = mbuf->dst_id; // set again on delivery
+    parkOrder.push_back(key);
+}
+
+void PktTrace::macTx(uint64_t key)
+{
+    auto it = parked.find(key);
+
+    if (it == parked.end()) {
+        return;
+    }
+    if (!it->second.t_mac_us) {
+        it->second.t_mac_us = nowUs();
+    }
+    it->second.tries++;
+}
+
+/* The receiver's mbuf gets the record of the packet it was copied from. A
+ * unicast is done once its dst got it, bcasts stay till TRACE_PARK_MAX
+ * pushes them out. */
+void PktTrace::unpark(uint64_t key, cl_nodeid_t id, msg_buf_t *mbuf)
+{
+    auto it = parked.find(key);
+
+    mbuf->flags &= ~MBUF_HAS_TRACE;
+    if (it == parked.end()) {
+        return;
+    }
+    if (mbuf->len + sizeof(wftrace_rec_t) <= COMMLINE_MAX_BUF) {
+        *trailer(mbuf) = it->second;
+        mbuf->flags |= MBUF_HAS_TRACE;
+    }
+    if (it->second.dst == id) {
+        parked.erase(it); // its key leaves parkOrder with the next evictions
+    }
+}
+
+void PktTrace::delivered(cl_nodeid_t id, msg_buf_t *mbuf)
+{
+    wftrace_rec_t t;
+
+    if (!fp || !(mbuf->flags & MBUF_HAS_TRACE)) {
+        return;
+    }
+    t          = *trailer(mbuf);
+    t.dst      = id;
+    t.len      = mbuf->len;
+    t.t_dlv_us = nowUs();
+    fwrite(&t, sizeof(t), 1, fp);
+    recs++;
+}
+
+int PktTrace::get_summary(char *buf, int buflen)
+{
+    if (!fp) {
+        return snprintf(buf, buflen, "TRACE: off");
+    }
+    fflush(fp);
+    return snprintf(buf, buflen, "TRACE: frames=%lu,records=%lu,parked=%zu",
+                    seq, recs, parked.size());
+}
+} // namespace wf
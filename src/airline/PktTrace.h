@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Per frame trace of the time spent in the airline
+ *
+ * With traceFile=<path> every data frame read from a stackline gets a
+ * wftrace_rec_t (utils/wftrace.h) behind its payload and MBUF_HAS_TRACE set.
+ * PHYs that queue the mbuf as is (fastwpan, graph) copy frameLen() bytes and
+ * stamp macTx() on every attempt. PHYs that turn the mbuf into an NS3 packet
+ * park() the record under the packet uid, which the packet copies on the
+ * receive side keep. The entry is dropped when a unicast reaches its dst. SendPacketToStackline() writes one record per receiver
+ * and never sends the trailer to the stackline. The airline is single
+ * threaded, hence no locking.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _PKTTRACE_H_
+#define _PKTTRACE_H_
+
+#include <deque>
+
+#include <common.h>
+#include "utils/wftrace.h"
+
+namespace wf {
+class PktTrace {
+private:
+    static FILE *                       fp;
+    static uint64_t                     seq;
+    static uint64_t                     recs;
+    static map<uint64_t, wftrace_rec_t> parked;
+    static deque<uint64_t>              parkOrder;
+
+    static wftrace_rec_t *trailer(msg_buf_t *mbuf)
+    {
+        return (wftrace_rec_t *)(mbuf->buf + mbuf->len);
+    };
+
+public:
+    static int  open(string path);
+    static void close(void);
+    static bool enabled(void)
+    {
+        return fp != NULL;
+    };
+    static uint16_t rxFlags(void)
+    {
+        return fp ? CL_FLAG_TSTAMP : 0;
+    };
+    static size_t frameLen(msg_buf_t *mbuf)
+    {
+        return sizeof(msg_buf_t) + mbuf->len +
+               ((mbuf->flags & MBUF_HAS_TRACE) ? sizeof(wftrace_rec_t) : 0);
+    };
+    static void rx(msg_buf_t *mbuf);
+    static void macTx(msg_buf_t *mbuf);
+    static void park(uint64_t key, msg_buf_t *mbuf);
+    static void macTx(uint64_t key);
+    static void unpark(uint64_t key, cl_nodeid_t id, msg_buf_t *mbuf);
+    static void delivered(cl_nodeid_t id, msg_buf_t *mbuf);
+    static int  get_summary(char *buf, int buflen);
+};
+} // namespace wf
+
+#endif // _PKTTRACE_H_
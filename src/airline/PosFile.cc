@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Packed binary node position file
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _POSFILE_CC_
+
+#include <stdio.h>
+#include <PosFile.h>
+
+namespace wf {
+int posFileWrite(const char *path, const vector<wf_posrec_t> &recs)
+{
+    wf_poshdr_t hdr;
+    FILE *      fp;
+    int         ret = SUCCESS;
+
+    fp = fopen(path, "wb");
+    if (!fp) {
+        ERROR("could not open pos file [%s] %m\n", path);
+        return FAILURE;
+    }
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic   = WF_POSFILE_MAGIC;
+    hdr.version = WF_POSFILE_VERSION;
+    hdr.rec_sz  = sizeof(wf_posrec_t);
+    hdr.count   = recs.size();
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1
+        || (recs.size() && fwrite(recs.data(), sizeof(wf_posrec_t), recs.size(), fp) != recs.size())) {
+        ERROR("pos file [%s] write failed\n", path);
+        ret = FAILURE;
+    }
+    fclose(fp);
+    return ret;
+}
+
+int posFileRead(const char *path, vector<wf_posrec_t> &recs)
+{
+    wf_poshdr_t hdr;
+    FILE *      fp;
+    int         ret = FAILURE;
+
+    fp = fopen(path, "rb");
+    if (!fp) {
+        ERROR("could not open pos file [%s] %m\n", path);
+        return FAILURE;
+    }
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != WF_POSFILE_MAGIC) {
+        ERROR("[%s] is not a position file\n", path);
+        goto done;
+    }
+    if (hdr.version != WF_POSFILE_VERSION || hdr.rec_sz != sizeof(wf_posrec_t)) {
+        ERROR("pos file [%s] unsupported ver=%d rec_sz=%d\n",
+              path, hdr.version, hdr.rec_sz);
+        goto done;
+    }
+    recs.resize(hdr.count);
+    if (hdr.count && fread(recs.data(), sizeof(wf_posrec_t), hdr.count, fp) != hdr.count) {
+        ERROR("pos file [%s] truncated, expected %u recs\n", path, hdr.count);
+        recs.clear();
+        goto done;
+    }
+    ret = SUCCESS;
+done:
+    fclose(fp);
+    return ret;
+}
+}; // namespace wf
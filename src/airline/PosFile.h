@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Packed binary node position file
+ *
+ * Used by the bulk position get/set commands. The file is a wf_poshdr_t
+ * followed by wf_poshdr_t::count wf_posrec_t records, all little endian.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _POSFILE_H_
+#define _POSFILE_H_
+
+#include <common.h>
+
+#define WF_POSFILE_MAGIC   0x53504657 // "WFPS"
+#define WF_POSFILE_VERSION 1
+
+#pragma pack(push, 1)
+typedef struct _wf_poshdr_ {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t rec_sz; // sizeof(wf_posrec_t), for forward compatibility
+    uint32_t count;
+    uint32_t rsvd;
+} wf_poshdr_t;
+
+typedef struct _wf_posrec_ {
+    uint32_t id;
+    double   x, y, z;
+} wf_posrec_t;
+#pragma pack(pop)
+
+namespace wf {
+int posFileWrite(const char *path, const vector<wf_posrec_t> &recs);
+int posFileRead(const char *path, vector<wf_posrec_t> &recs);
+}; // namespace wf
+
+#endif // _POSFILE_H_
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Disjoint node id range to value map
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _RANGEMAP_CC_
+
+#include <RangeMap.h>
+
+namespace wf {
+void RangeMap::assign(int beg, int end, uint32_t val)
+{
+    auto it = ranges.upper_bound(beg);
+
+    if (it != ranges.begin() && prev(it)->second.end >= beg) {
+        --it;
+    }
+
+    /* Cut out [beg-end] from the overlapping ranges */
+    while (it != ranges.end() && it->first <= end) {
+        int     rbeg = it->first;
+        range_t r    = it->second;
+
+        it = ranges.erase(it);
+        if (rbeg < beg) {
+            ranges[rbeg] = { beg - 1, r.val };
+        }
+        if (r.end > end) {
+            it = ranges.insert(it, { end + 1, { r.end, r.val } });
+            break;
+        }
+    }
+
+    /* Coalesce with neighbours having the same value */
+    it = ranges.insert(it, { beg, { end, val } });
+    auto nx = next(it);
+    if (nx != ranges.end() && nx->first == end + 1 && nx->second.val == val) {
+        it->second.end = nx->second.end;
+        ranges.erase(nx);
+    }
+    if (it != ranges.begin()) {
+        auto pv = prev(it);
+        if (pv->second.end == beg - 1 && pv->second.val == val) {
+            pv->second.end = it->second.end;
+            ranges.erase(it);
+        }
+    }
+}
+}; // namespace wf
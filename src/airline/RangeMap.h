@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Disjoint node id range to value map
+ *
+ * Holds the values of one per-node cfg key. A key[0-49999]=val is stored as
+ * a single interval rather than once per node. Later assignments override
+ * the overlapping part of earlier ones, same as the cfg file semantics.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _RANGEMAP_H_
+#define _RANGEMAP_H_
+
+#include <common.h>
+
+namespace wf {
+class RangeMap {
+private:
+    typedef struct _range_ {
+        int      end;
+        uint32_t val;
+    } range_t;
+    map<int, range_t> ranges; // keyed by range begin
+
+public:
+    void assign(int beg, int end, uint32_t val);
+    bool lookup(int id, uint32_t &val) const
+    {
+        auto it = ranges.upper_bound(id);
+
+        if (it == ranges.begin()) {
+            return false;
+        }
+        --it;
+        if (id > it->second.end) {
+            return false;
+        }
+        val = it->second.val;
+        return true;
+    };
+    size_t size(void) const
+    {
+        return ranges.size();
+    };
+};
+}; // namespace wf
+
+#endif // _RANGEMAP_H_
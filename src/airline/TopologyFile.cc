@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Topology file loader for large deployments
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _TOPOLOGYFILE_CC_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <TopologyFile.h>
+
+#define TOPO_RDBUF_SZ (1 << 20)
+
+namespace wf {
+
+/* Returns ptr to the next field or NULL if line ended */
+static char *nextField(char *p)
+{
+    while (*p && *p != ',') p++;
+    if (!*p) return NULL;
+    p++;
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+static bool fieldIsKV(const char *p)
+{
+    for (; *p && *p != ','; p++) {
+        if (*p == '=') return true;
+    }
+    return false;
+}
+
+static int parseLine(char *line, long lineno, vector<wf_posrec_t> &recs,
+                     vector<wf_topoattr_t> &attrs)
+{
+    wf_posrec_t rec;
+    char *      p = line, *end;
+
+    while (*p == ' ' || *p == '\t') p++;
+    if (!*p || *p == '#') return SUCCESS;
+
+    rec.id = strtoul(p, &end, 0);
+    if (end == p) {
+        if (recs.empty()) return SUCCESS; // header line
+        ERROR("topologyFile line %ld: invalid node id\n", lineno);
+        return FAILURE;
+    }
+    if (!(p = nextField(end))) goto incomplete;
+    rec.x = strtod(p, &end);
+    if (end == p || !(p = nextField(end))) goto incomplete;
+    rec.y = strtod(p, &end);
+    if (end == p) goto incomplete;
+    rec.z = 0;
+    p     = nextField(end);
+    if (p && !fieldIsKV(p)) {
+        rec.z = strtod(p, &end);
+        p     = nextField(end);
+    }
+    recs.push_back(rec);
+
+    for (; p; p = nextField(end)) {
+        char *eq = strchr(p, '=');
+
+        if (!fieldIsKV(p)) {
+            ERROR("topologyFile line %ld: expected key=value\n", lineno);
+            return FAILURE;
+        }
+        for (end = eq; *end && *end != ','; end++)
+            ;
+        string key(p, eq - p), val(eq + 1, end - eq - 1);
+        attrs.push_back({ rec.id, trim(key), trim(val) });
+    }
+    return SUCCESS;
+
+incomplete:
+    ERROR("topologyFile line %ld: expected id,x,y[,z]\n", lineno);
+    return FAILURE;
+}
+
+/*
+ * Streams the CSV in large chunks and parses it in place. Avoids
+ * iostream/getline/split/stod so that 10^5 lines load in milliseconds.
+ */
+static int csvLoad(FILE *fp, vector<wf_posrec_t> &recs,
+                   vector<wf_topoattr_t> &attrs)
+{
+    char * buf, *line, *nl, *eol;
+    size_t len = 0, rd;
+    long   lineno = 0;
+    int    ret    = SUCCESS;
+
+    buf = (char *)malloc(TOPO_RDBUF_SZ + 1);
+    if (!buf) {
+        ERROR("topologyFile read buf alloc failed\n");
+        return FAILURE;
+    }
+    do {
+        rd = fread(buf + len, 1, TOPO_RDBUF_SZ - len, fp);
+        len += rd;
+        buf[len] = 0;
+        line     = buf;
+        while ((nl = (char *)memchr(line, '\n', buf + len - line))
+               || (!rd && line < buf + len)) {
+            eol  = nl ? nl : buf + len;
+            *eol = 0;
+            if (eol > line && eol[-1] == '\r') eol[-1] = 0;
+            if (parseLine(line, ++lineno, recs, attrs) != SUCCESS) {
+                ret = FAILURE;
+                goto done;
+            }
+            line = nl ? nl + 1 : eol;
+        }
+        len -= line - buf;
+        if (len >= TOPO_RDBUF_SZ) {
+            ERROR("topologyFile line %ld too long\n", lineno + 1);
+            ret = FAILURE;
+            goto done;
+        }
+        memmove(buf, line, len);
+    } while (rd);
+done:
+    free(buf);
+    return ret;
+}
+
+int topoFileLoad(const char *path, vector<wf_posrec_t> &recs,
+                 vector<wf_topoattr_t> &attrs)
+{
+    uint32_t magic = 0;
+    FILE *   fp;
+    int      ret;
+
+    fp = fopen(path, "rb");
+    if (!fp) {
+        ERROR("could not open topologyFile [%s] %m\n", path);
+        return FAILURE;
+    }
+    if (fread(&magic, sizeof(magic), 1, fp) == 1 && magic == WF_POSFILE_MAGIC) {
+        fclose(fp);
+        return posFileRead(path, recs);
+    }
+    rewind(fp);
+    ret = csvLoad(fp, recs, attrs);
+    fclose(fp);
+    return ret;
+}
+}; // namespace wf
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Topology file loader for large deployments
+ *
+ * The topology file is either the packed binary position file (PosFile.h)
+ * or a CSV with one node per line:
+ *     id,x,y[,z][,key=value...]
+ * Lines starting with '#' and a non-numeric header line are ignored. The
+ * key=value attributes are applied as per-node config (as if specified
+ * using key[id]=value in the cfg).
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _TOPOLOGYFILE_H_
+#define _TOPOLOGYFILE_H_
+
+#include <PosFile.h>
+
+typedef struct _wf_topoattr_ {
+    uint32_t id;
+    string   key;
+    string   val;
+} wf_topoattr_t;
+
+namespace wf {
+int topoFileLoad(const char *path, vector<wf_posrec_t> &recs,
+                 vector<wf_topoattr_t> &attrs);
+}; // namespace wf
+
+#endif // _TOPOLOGYFILE_H_
@@ -23,6 +23,9 @@
 #include <common.h>
 #include <Nodeinfo.h>
 #include <Config.h>
+#include <MbufPool.h>
+#include <PktTrace.h>
+#include <PktRecord.h>
 
 // trim from left
 string& ltrim(string& s, const char* t)
@@ -86,10 +89,10 @@ string getMapCfg(map<string, string, ci_less> & m, string key)
     return val;
 }
 
-void SendAckToStackline(uint16_t src_id, uint16_t dst_id,
+void SendAckToStackline(cl_nodeid_t src_id, cl_nodeid_t dst_id,
         uint8_t status, int retries)
 {
-    DEFINE_MBUF(mbuf);
+    POOL_MBUF(mbuf);
 
     mbuf->src_id = src_id;
     mbuf->dst_id = dst_id;
@@ -100,13 +103,34 @@ void SendAckToStackline(uint16_t src_id, uint16_t dst_id,
     mbuf->flags |= MBUF_IS_ACK;
     mbuf->len = 1;
     wf::Macstats::set_stats(AL_RX, mbuf);
+    wf::MbufPool::sent();
+    if (wf::PktRecord::replay()) {
+        wf::PktRecord::txDropped();
+        return;
+    }
     cl_sendto_q(MTYPE(STACKLINE, mbuf->src_id), mbuf, sizeof(msg_buf_t));
 }
 
-void SendPacketToStackline(uint16_t id, msg_buf_t *mbuf)
+void SendPacketToStackline(cl_nodeid_t id, msg_buf_t *mbuf)
 {
+    wf::Nodeinfo *ni = WF_config.get_node_info(id);
+    uint8_t       flags;
+
+    if (ni && ni->isRadioOff()) {
+        wf::Macstats::set_rx_missed(id);
+        return;
+    }
+    wf::PktTrace::delivered(id, mbuf);
+    wf::MbufPool::sent();
     wf::Macstats::set_stats(AL_RX, mbuf);
+    if (wf::PktRecord::replay()) {
+        wf::PktRecord::txDropped();
+        return;
+    }
+    flags = mbuf->flags; // the trailer stays with the airline
+    mbuf->flags &= ~MBUF_HAS_TRACE;
     cl_sendto_q(MTYPE(STACKLINE, id), mbuf, sizeof(msg_buf_t) + mbuf->len);
+    mbuf->flags = flags;
 #if 0
     CINFO << "RX data"
          << " src_id=" << id << " dst_id=" << mbuf->dst_id
@@ -83,8 +83,8 @@ static inline int stricmp(string s1, string s2)
     return strcasecmp(s1.c_str(), s2.c_str());
 }
 
-void SendAckToStackline(uint16_t src_id, uint16_t dst_id,
+void SendAckToStackline(cl_nodeid_t src_id, cl_nodeid_t dst_id,
                         uint8_t status, int retries);
-void SendPacketToStackline(uint16_t id, msg_buf_t *mbuf);
+void SendPacketToStackline(cl_nodeid_t id, msg_buf_t *mbuf);
 
 #endif //_COMMON_H_
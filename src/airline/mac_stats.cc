@@ -30,7 +30,7 @@ namespace wf {
 		if(mbuf->flags & MBUF_IS_CMD) {
 			return;
 		}
-		if(mbuf->dst_id == 0xffff) {
+		if(mbuf->dst_id == CL_BCAST_ID) {
 			stats.tx_mc_pkts++;
 		} else {
 			stats.tx_pkts++;
@@ -67,14 +67,22 @@ namespace wf {
 	{
 		Nodeinfo *ni=NULL;
 		gettimeofday(&tv, NULL);
-		for(uint16_t i=0;;i++) {
+		for(cl_nodeid_t i=0;;i++) {
 			ni=WF_config.get_node_info(i);
 			if(!ni) break;
 			ni->reset();
 		}
 	};
 
-	int Macstats::get_summary(uint16_t id, char *buf, int buflen)
+	void Macstats::clear_node(cl_nodeid_t id)
+	{
+		Nodeinfo *ni=WF_config.get_node_info(id);
+		if(ni) {
+			ni->reset();
+		}
+	};
+
+	int Macstats::get_summary(cl_nodeid_t id, char *buf, int buflen)
 	{
 		stats_t st;
 		Nodeinfo *ni=NULL;
@@ -84,7 +92,7 @@ namespace wf {
 			struct timeval etv;
 			gettimeofday(&etv, NULL);
 			memset(&st, 0, sizeof(st));
-			for(uint16_t i=0;;i++) {
+			for(cl_nodeid_t i=0;;i++) {
 				ni=WF_config.get_node_info(i);
 				if(!ni) break;
 				add_stats(st, ni->get_stats());
@@ -108,6 +116,8 @@ namespace wf {
 			n += snprintf(buf+n, buflen-n-1, ",tx_attempt%d=%ld", 
 						i, st.rx_ack_ok[i]);
 		}
+		n += snprintf(buf+n, buflen-n-1, "\nRADIO_OFF: rx_missed=%ld",
+					st.rx_missed);
 		return n;
 	};
 
@@ -140,4 +150,11 @@ namespace wf {
 		ni->set(dir, mbuf);
 	};
 
+	void Macstats::set_rx_missed(cl_nodeid_t id) {
+		Nodeinfo *ni=WF_config.get_node_info(id);
+		if(ni) {
+			ni->stats.rx_missed++;
+		}
+	};
+
 } //namespace ns3
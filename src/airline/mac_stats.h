@@ -36,6 +36,7 @@ typedef struct _stats_ {
     uint64_t rx_pkts, rx_ack_ok[MAX_MAC_TX_RETRY_CNT], tx_fail;
     uint64_t tx_mc_pkts;
     uint64_t rx_mc_pkts;
+    uint64_t rx_missed; // not delivered since the radio was off
 } stats_t;
 class Macstats {
 private:
@@ -61,6 +62,7 @@ protected:
         s.tx_fail += b.tx_fail;
         s.tx_mc_pkts += b.tx_mc_pkts;
         s.rx_mc_pkts += b.rx_mc_pkts;
+        s.rx_missed += b.rx_missed;
         for (int i = 0; i < MAX_MAC_TX_RETRY_CNT; i++) {
             s.rx_ack_ok[i] += b.rx_ack_ok[i];
         }
@@ -72,7 +74,9 @@ protected:
 
 public:
     static void set_stats(int dir, const msg_buf_t *mbuf);
-    static int  get_summary(uint16_t id, char *buf, int buflen);
+    static void set_rx_missed(cl_nodeid_t id);
+    static void clear_node(cl_nodeid_t id);
+    static int  get_summary(cl_nodeid_t id, char *buf, int buflen);
     Macstats()
     {
         memset(&stats, 0, sizeof(stats));
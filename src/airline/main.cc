@@ -22,11 +22,14 @@
 
 #include <signal.h>
 #include <unistd.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
 #include <common.h>
 #include <sys/prctl.h>
 #include <Manager.h>
 extern "C" {
 #include "commline/commline.h"
+#include "utils/cpu_sched.h"
 }
 
 void sig_handler(int signum)
@@ -35,10 +38,42 @@ void sig_handler(int signum)
 		CINFO << "Airline Caught signal " << signum << endl;
 	}
 	cl_cleanup();
+	// exit() flushes the trace and record files
 	CINFO << "Sayonara " << signum << "...\n";
 	exit(signum);
 }
 
+pid_t g_forker_pid;
+
+/* Stacklines are children of the forker which reaps them. Only the forker
+ * exiting is fatal for the airline. */
+void sigchld_handler(int signum)
+{
+	int status;
+	if(g_forker_pid > 0 && waitpid(g_forker_pid, &status, WNOHANG) == g_forker_pid) {
+		sig_handler(signum);
+	}
+}
+
+/* Global settings that the forker reads from its env */
+void export_forker_env(void)
+{
+	static const char *env[][2] = {
+		{ "cgroupRoot",    "WF_CGROUP_ROOT"    },
+		{ "logAggregate",  "WF_LOG_AGGR"       },
+		{ "logRotateMB",   "WF_LOG_ROTATE_MB"  },
+		{ "logRotateKeep", "WF_LOG_KEEP"       },
+		{ "logRateLimit",  "WF_LOG_RATE"       },
+		{ "ptyScrollback", "WF_PTY_SCROLLBACK" },
+	};
+	for(auto &e : env) {
+		string val = CFG(e[0]);
+		if(!val.empty()) {
+			setenv(e[1], val.c_str(), 1);
+		}
+	}
+}
+
 void exec_forker(void)
 {
 	char *cmdname=getenv("FORKER");
@@ -46,7 +81,8 @@ void exec_forker(void)
 		CERROR << "Could not find forker env var\n";
 		sig_handler(1);
 	}
-	if(0 == fork()) {
+	g_forker_pid = fork();
+	if(0 == g_forker_pid) {
 		char *argv[10] = {
 			cmdname,
 			NULL,
@@ -63,6 +99,40 @@ void exec_forker(void)
 	}
 }
 
+/*
+ * Keeps the airline off the cores used by the stacklines. Called after the
+ * forker is spawned so that it and the stacklines do not inherit these
+ * settings. Threads created later inherit the affinity and policy.
+ */
+void set_airline_sched(void)
+{
+	string cpus = CFG("airlineCpuSet");
+	int prio = CFG_INT("airlineSchedFifo", 0);
+
+	if(!cpus.empty()) {
+		cpu_set_t set;
+		if(parse_cpulist(cpus.c_str(), &set) <= 0) {
+			CERROR << "Invalid airlineCpuSet=" << cpus << endl;
+		} else if(sched_setaffinity(0, sizeof(set), &set)) {
+			CERROR << "sched_setaffinity(" << cpus << ") failed: " << strerror(errno) << endl;
+		} else {
+			CINFO << "Airline pinned to cpus " << cpus << endl;
+		}
+	}
+	if(prio > 0) {
+		struct sched_param sp;
+		sp.sched_priority = prio;
+		if(sched_setscheduler(0, SCHED_FIFO, &sp)) {
+			CERROR << "SCHED_FIFO prio " << prio << " failed: " << strerror(errno) << endl;
+		}
+	}
+	if(CFG_INT("airlineMlockall", 0)) {
+		if(mlockall(MCL_CURRENT | MCL_FUTURE)) {
+			CERROR << "mlockall failed: " << strerror(errno) << endl;
+		}
+	}
+}
+
 #if 0
 ofstream g_errout;
 void redirect_log(void)
@@ -89,7 +159,7 @@ int main(const int argc, const char *argv[])
 	signal(SIGKILL, sig_handler);
 	signal(SIGTERM, sig_handler);
 	//signal(SIGSEGV, sig_handler);
-	signal(SIGCHLD, sig_handler);
+	signal(SIGCHLD, sigchld_handler);
 
 	if(SUCCESS != cl_init(MTYPE(AIRLINE, CL_MGR_ID), CL_CREATEQ)) {
 		CERROR << "Whitefield is already running\n";
@@ -100,7 +170,9 @@ int main(const int argc, const char *argv[])
 		sig_handler(1);
 	}
 	//redirect_log();
+	export_forker_env();
 	exec_forker();
+	set_airline_sched();
 	Manager WF_mgr(WF_config);
 	sig_handler(0);
 	return 0;
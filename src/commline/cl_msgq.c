@@ -42,7 +42,7 @@ key_t get_msgq_key(void)
     return ftok(getcwd(buf, sizeof(buf)), 0xab);
 }
 
-int msgq_init(const long my_mtype, const uint8_t flags)
+int msgq_init(const cl_mtype_t my_mtype, const uint8_t flags)
 {
     key_t key;
     int   msgflag = 0666 | IPC_CREAT;
@@ -71,24 +71,32 @@ void msgq_cleanup(void)
     INFO("msgq deleted\n");
 }
 
-int msgq_recvfrom(const long mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags)
+int msgq_recvfrom(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags)
 {
     int ret;
 
     mbuf->len = 0;
+    if (GET_ID(mtype) > CL_LEGACY_MAX_ID && GET_ID(mtype) != CL_MGR_ID) {
+        ERROR("msgq supports only 16 bit node ids\n");
+        return FAILURE;
+    }
 
-    ret = msgrcv(gMsgQ_id, (void *)mbuf, len, mtype, (flags & CL_FLAG_NOWAIT) ? IPC_NOWAIT : 0);
-    if (ret > 0 && ret + 4 < sizeof(msg_buf_t)) //Rahul: +4 is added for bins compiled with -m32. sizeof(long) issue.
+    ret = msgrcv(gMsgQ_id, (void *)mbuf, len, CL_LEGACY_MTYPE(mtype), (flags & CL_FLAG_NOWAIT) ? IPC_NOWAIT : 0);
+    if (ret > 0 && ret + 4 < sizeof(msg_buf_v1_t)) //Rahul: +4 is added for bins compiled with -m32. sizeof(long) issue.
     {
-        ERROR("some problem ... msgrcv length(%d) not enough sizeof:%zu\n", ret, sizeof(msg_buf_t));
+        ERROR("some problem ... msgrcv length(%d) not enough sizeof:%zu\n", ret, sizeof(msg_buf_v1_t));
         return FAILURE;
     }
     return ret;
 }
 
-int msgq_sendto(const long mtype, msg_buf_t *mbuf, uint16_t len)
+int msgq_sendto(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len)
 {
-    mbuf->mtype = mtype;
+    if (GET_ID(mtype) > CL_LEGACY_MAX_ID && GET_ID(mtype) != CL_MGR_ID) {
+        ERROR("msgq supports only 16 bit node ids\n");
+        return FAILURE;
+    }
+    mbuf->mtype = CL_LEGACY_MTYPE(mtype);
     if (msgsnd(gMsgQ_id, (void *)mbuf, len, 0) < 0) {
         ERROR("msgsend failed!\n");
         return FAILURE;
@@ -21,10 +21,10 @@
 #ifndef _CL_MSGQ_H_
 #define _CL_MSGQ_H_
 
-int  msgq_init(const long my_mtype, const uint8_t flags);
+int  msgq_init(const cl_mtype_t my_mtype, const uint8_t flags);
 void msgq_cleanup(void);
-int  msgq_recvfrom(const long mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags);
-int  msgq_sendto(const long mtype, msg_buf_t *mbuf, uint16_t len);
+int  msgq_recvfrom(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags);
+int  msgq_sendto(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len);
 
 #define CL_INIT     msgq_init
 #define CL_CLEANUP  msgq_cleanup
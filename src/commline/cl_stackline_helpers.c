@@ -31,35 +31,75 @@
 
 static uint8_t g_serial_id[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
 
-int cl_get_id2longaddr(const uint16_t id, uint8_t *addr, const int addrlen)
+/*
+ * Ids upto 0xffff map to 01:02:03:04:05:06:<id16> as before. Larger ids use
+ * 01:02:03:<0x84>:<id32>, 0x84 being the marker for the 32 bit form.
+ */
+#define LONGADDR_ID32_MARKER 0x84
+
+int cl_get_id2longaddr(const cl_nodeid_t id, uint8_t *addr, const int addrlen)
 {
     if (addrlen != 8) {
         ERROR("Invalid addrlen:%d\n", addrlen);
         return FAILURE;
     }
-    if (id == 0xffff) {
+    if (id == CL_BCAST_ID) {
         memset(addr, 0, addrlen);
         return SUCCESS;
     }
 
-    char *ptr = (char *)&id;
-
     memcpy(addr, g_serial_id, 8);
-    addr[6] = ptr[1];
-    addr[7] = ptr[0];
+    if (id > 0xffff) {
+        addr[3] = LONGADDR_ID32_MARKER;
+        addr[4] = id >> 24;
+        addr[5] = id >> 16;
+    }
+    addr[6] = id >> 8;
+    addr[7] = id;
     return SUCCESS;
 }
 
-uint16_t cl_get_longaddr2id(const uint8_t *addr)
+cl_nodeid_t cl_get_longaddr2id(const uint8_t *addr)
 {
     if (!addr || !(addr[0] | addr[1] | addr[2] | addr[3] | addr[4] | addr[5] | addr[6] | addr[7])) {
-        return 0xffff;
+        return CL_BCAST_ID;
     }
-    uint16_t nodeid;
-    uint8_t *ptr = (uint8_t *)&nodeid;
-    ptr[0]       = addr[7];
-    ptr[1]       = addr[6];
-    return nodeid;
+    if (addr[3] == LONGADDR_ID32_MARKER) {
+        return ((cl_nodeid_t)addr[4] << 24) | (addr[5] << 16) | (addr[6] << 8) | addr[7];
+    }
+    return (addr[6] << 8) | addr[7];
+}
+
+/*
+ * Asks the airline to tune the node's radio to the given channel, e.g. for
+ * channel hopping or multi-PAN setups. The airline does not respond.
+ */
+int cl_set_channel(const cl_nodeid_t id, const uint8_t channel)
+{
+    DEFINE_MBUF(mbuf);
+
+    mbuf->src_id = id;
+    mbuf->dst_id = CL_MGR_ID;
+    mbuf->flags  = MBUF_IS_CMD | MBUF_DO_NOT_RESPOND;
+    mbuf->len    = snprintf((char *)mbuf->buf, mbuf->max_len,
+                            "cmd_802154_set_channel:%d", channel);
+    return cl_sendto_q(MTYPE(AIRLINE, CL_MGR_ID), mbuf, sizeof(msg_buf_t) + mbuf->len);
+}
+
+/*
+ * Duty cycling stacklines mark their radio off/on. The airline does not
+ * deliver frames to a node whose radio is off and counts them as missed.
+ */
+int cl_set_radio(const cl_nodeid_t id, const uint8_t on)
+{
+    DEFINE_MBUF_SZ(mbuf, 1);
+
+    mbuf->src_id = id;
+    mbuf->dst_id = CL_MGR_ID;
+    mbuf->flags  = MBUF_IS_CTRL;
+    mbuf->buf[0] = on ? CL_CTRL_RADIO_ON : CL_CTRL_RADIO_OFF;
+    mbuf->len    = 1;
+    return cl_sendto_q(MTYPE(AIRLINE, CL_MGR_ID), mbuf, sizeof(msg_buf_t) + mbuf->len);
 }
 
 #if USE_DL //------------------[USE_DL-if]-----------------
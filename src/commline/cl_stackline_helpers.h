@@ -25,9 +25,11 @@
 extern "C" {
 #endif
 
-int      cl_get_id2longaddr(const uint16_t id, uint8_t *addr, const int addrlen);
-uint16_t cl_get_longaddr2id(const uint8_t *addr);
-void     sl_handle_cmd(msg_buf_t *mbuf);
+int         cl_get_id2longaddr(const cl_nodeid_t id, uint8_t *addr, const int addrlen);
+cl_nodeid_t cl_get_longaddr2id(const uint8_t *addr);
+int         cl_set_channel(const cl_nodeid_t id, const uint8_t channel);
+int         cl_set_radio(const cl_nodeid_t id, const uint8_t on);
+void        sl_handle_cmd(msg_buf_t *mbuf);
 
 #ifdef __cplusplus
 }
@@ -27,6 +27,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/time.h>
 #include <errno.h>
 
 #include <commline.h>
@@ -35,25 +36,39 @@
 int g_usock_fd[MAX_CL_LINE] = { -1 };
 int g_def_line              = -1;
 
-socklen_t usock_setabsaddr(const long mtype, struct sockaddr_un *addr)
+static uint8_t  g_tstamp_on[MAX_CL_LINE];
+static uint64_t g_rx_tstamp;
+
+/*
+ * Ids addressable by legacy stacklines keep the legacy socket name so that
+ * they can still find each other.
+ */
+socklen_t usock_setabsaddr(const cl_mtype_t mtype, struct sockaddr_un *addr)
 {
-    int   len;
-    uid_t uid = getuid();
+    int         len;
+    uid_t       uid = getuid();
+    cl_nodeid_t id  = GET_ID(mtype);
 
     addr->sun_family  = AF_UNIX;
     addr->sun_path[0] = 0;
-    len               = snprintf(&addr->sun_path[1], sizeof(addr->sun_path) - 1, "/WHITEFIELD_%d_%08lx", uid, mtype);
+    if (id <= CL_LEGACY_MAX_ID || id == CL_MGR_ID) {
+        len = snprintf(&addr->sun_path[1], sizeof(addr->sun_path) - 1,
+                       "/WHITEFIELD_%d_%08x", uid, (uint32_t)CL_LEGACY_MTYPE(mtype));
+    } else {
+        len = snprintf(&addr->sun_path[1], sizeof(addr->sun_path) - 1,
+                       "/WHITEFIELD_%d_%x_%08x", uid, GET_LINE(mtype), id);
+    }
     return sizeof(sa_family_t) + len + 1;
 }
 
-int usock_init(const long my_mtype, const uint8_t flags)
+int usock_init(const cl_mtype_t my_mtype, const uint8_t flags)
 {
     socklen_t          slen;
     struct sockaddr_un addr;
     int                line = GET_LINE(my_mtype);
 
     if (!IN_RANGE(line, 1, MAX_CL_LINE)) {
-        ERROR("my_mtype:%08lx not in range!\n", my_mtype);
+        ERROR("my_mtype:%016llx not in range!\n", (unsigned long long)my_mtype);
         return FAILURE;
     }
 
@@ -86,34 +101,79 @@ void usock_cleanup(void)
     INFO("closed commline unix sockets\n");
 }
 
-int usock_recvfrom(const long my_mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags)
+/* Kernel timestamp (CLOCK_REALTIME) of the time the frame was queued to the
+ * socket. The difference to now is the time it waited for the reader. The
+ * option is set on the first such read, frames already queued by then are
+ * stamped at read time. */
+static int recv_tstamp(int line, msg_buf_t *mbuf, uint16_t len, uint16_t flags)
+{
+    char            ctrl[CMSG_SPACE(sizeof(struct timeval))];
+    struct iovec    iov = { mbuf, len };
+    struct msghdr   msg;
+    struct cmsghdr *cm;
+    struct timeval  tv;
+    int             on = 1, ret;
+
+    if (!g_tstamp_on[line]) {
+        if (setsockopt(g_usock_fd[line], SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on))) {
+            ERROR("SO_TIMESTAMP failed errno=%d\n", errno);
+        }
+        g_tstamp_on[line] = 1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    g_rx_tstamp        = 0;
+
+    ret = recvmsg(g_usock_fd[line], &msg, (flags & CL_FLAG_NOWAIT) ? MSG_DONTWAIT : 0);
+    for (cm = CMSG_FIRSTHDR(&msg); ret > 0 && cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMP) {
+            memcpy(&tv, CMSG_DATA(cm), sizeof(tv));
+            g_rx_tstamp = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+        }
+    }
+    return ret;
+}
+
+uint64_t usock_rx_tstamp(void)
+{
+    return g_rx_tstamp;
+}
+
+int usock_recvfrom(const cl_mtype_t my_mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags)
 {
     int ret;
     int line = GET_LINE(my_mtype);
 
     if (!IN_RANGE(line, 1, MAX_CL_LINE)) {
-        ERROR("my_mtype:%08lx not in range!\n", my_mtype);
+        ERROR("my_mtype:%016llx not in range!\n", (unsigned long long)my_mtype);
         return FAILURE;
     }
 
     mbuf->len = 0;
 
-    ret = recvfrom(g_usock_fd[line], (void *)mbuf, len, (flags & CL_FLAG_NOWAIT) ? MSG_DONTWAIT : 0, NULL, 0);
-    if (ret > 0 && ret + 4 < sizeof(msg_buf_t)) //Rahul: +4 is added for bins compiled with -m32. sizeof(long) issue.
+    if (flags & CL_FLAG_TSTAMP) {
+        ret = recv_tstamp(line, mbuf, len, flags);
+    } else {
+        ret = recvfrom(g_usock_fd[line], (void *)mbuf, len, (flags & CL_FLAG_NOWAIT) ? MSG_DONTWAIT : 0, NULL, 0);
+    }
+    if (ret > 0 && ret + 4 < sizeof(msg_buf_v1_t)) //Rahul: +4 is added for bins compiled with -m32. sizeof(long) issue.
     {
-        ERROR("problem ... recvfrom len(%d) not enough sizeof:%zu\n", ret, sizeof(msg_buf_t));
+        ERROR("problem ... recvfrom len(%d) not enough sizeof:%zu\n", ret, sizeof(msg_buf_v1_t));
         return FAILURE;
     }
     return ret;
 }
 
-int usock_sendto(const long mtype, msg_buf_t *mbuf, uint16_t len)
+int usock_sendto(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len)
 {
     struct sockaddr_un addr;
     socklen_t          slen;
     int                ret;
 
-    mbuf->mtype = mtype;
+    mbuf->mtype = CL_LEGACY_MTYPE(mtype);
 
     slen = usock_setabsaddr(mtype, &addr);
     ret  = sendto(g_usock_fd[g_def_line], (void *)mbuf, len, 0, (struct sockaddr *)&addr, slen);
@@ -124,16 +184,16 @@ int usock_sendto(const long mtype, msg_buf_t *mbuf, uint16_t len)
     return SUCCESS;
 }
 
-int usock_get_descriptor(const long mtype)
+int usock_get_descriptor(const cl_mtype_t mtype)
 {
     int line = GET_LINE(mtype);
 
     if (!IN_RANGE(line, 1, MAX_CL_LINE)) {
-        ERROR("my_mtype:%08lx not in range!\n", mtype);
+        ERROR("my_mtype:%016llx not in range!\n", (unsigned long long)mtype);
         return FAILURE;
     }
     if (g_usock_fd[line] <= 0) {
-        ERROR("mtype:%08lx line:%d no fd here\n", mtype, line);
+        ERROR("mtype:%016llx line:%d no fd here\n", (unsigned long long)mtype, line);
         return FAILURE;
     }
 
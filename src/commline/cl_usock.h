@@ -21,11 +21,12 @@
 #ifndef _CL_USOCK_H_
 #define _CL_USOCK_H_
 
-int  usock_init(const long my_mtype, const uint8_t flags);
-void usock_cleanup(void);
-int  usock_recvfrom(const long mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags);
-int  usock_sendto(const long mtype, msg_buf_t *mbuf, uint16_t len);
-int  usock_get_descriptor(const long mtype);
+int      usock_init(const cl_mtype_t my_mtype, const uint8_t flags);
+void     usock_cleanup(void);
+int      usock_recvfrom(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags);
+int      usock_sendto(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len);
+int      usock_get_descriptor(const cl_mtype_t mtype);
+uint64_t usock_rx_tstamp(void);
 
 #define CL_INIT           usock_init
 #define CL_CLEANUP        usock_cleanup
@@ -21,6 +21,8 @@
 #define _COMMLINE_C_
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdint.h>
 #include <commline.h>
@@ -32,12 +34,119 @@
 #include <cl_msgq.h>
 #endif
 
-int cl_init(const long my_mtype, const uint8_t flags)
+#define V1_HDR_LEN  offsetof(msg_buf_v1_t, buf)
+#define V2_HDR_DIFF (offsetof(msg_buf_t, buf) - V1_HDR_LEN)
+
+/*
+ * Peers (node ids) whose header version is known. Legacy peers are learned
+ * from the frames they send. WF_CL_LEGACY_PEERS=1 in env makes the peers not
+ * heard from yet to be treated as legacy.
+ */
+static uint8_t g_peer_known[(CL_LEGACY_MAX_ID + 8) / 8];
+static uint8_t g_peer_legacy[(CL_LEGACY_MAX_ID + 8) / 8];
+
+#define BIT_GET(MAP, ID) ((MAP)[(ID) >> 3] & (1 << ((ID)&7)))
+#define BIT_SET(MAP, ID, VAL)                  \
+    if (VAL)                                   \
+        (MAP)[(ID) >> 3] |= (1 << ((ID)&7));   \
+    else                                       \
+        (MAP)[(ID) >> 3] &= ~(1 << ((ID)&7));
+
+void cl_set_legacy_peer(const cl_nodeid_t id, const int legacy)
+{
+    if (id > CL_LEGACY_MAX_ID) {
+        return;
+    }
+    BIT_SET(g_peer_known, id, 1);
+    BIT_SET(g_peer_legacy, id, legacy);
+}
+
+static int is_legacy_peer(const cl_nodeid_t id)
+{
+    static int def_legacy = -1;
+
+    if (id > CL_LEGACY_MAX_ID) {
+        return 0;
+    }
+    if (BIT_GET(g_peer_known, id)) {
+        return !!BIT_GET(g_peer_legacy, id);
+    }
+    if (def_legacy < 0) {
+        const char *env = getenv("WF_CL_LEGACY_PEERS");
+        def_legacy      = env && atoi(env);
+    }
+    return def_legacy;
+}
+
+static cl_nodeid_t v1_to_id(const uint16_t id)
+{
+    if (id == 0xffff)
+        return CL_BCAST_ID;
+    if (id == 0xfffe)
+        return CL_DSTID_MACHDR_PRESENT;
+    return id;
+}
+
+static int id_to_v1(const cl_nodeid_t id, uint16_t *v1id)
+{
+    if (id == CL_BCAST_ID)
+        *v1id = 0xffff;
+    else if (id == CL_DSTID_MACHDR_PRESENT)
+        *v1id = 0xfffe;
+    else if (id <= CL_LEGACY_MAX_ID)
+        *v1id = id;
+    else
+        return FAILURE;
+    return SUCCESS;
+}
+
+/* Converts a rcvd v1 frame to v2 in place, returns the new frame len */
+static int hdr_v1_to_v2(msg_buf_t *mbuf, int ret, uint16_t len)
+{
+    msg_buf_v1_t *v1 = (msg_buf_v1_t *)mbuf;
+    uint16_t      src_id, dst_id;
+
+    if (ret < (int)V1_HDR_LEN || ret + V2_HDR_DIFF > len) {
+        ERROR("legacy frame len:%d does not fit buflen:%d\n", ret, len);
+        return FAILURE;
+    }
+    src_id = v1->src_id;
+    dst_id = v1->dst_id;
+    memmove(mbuf->buf, v1->buf, ret - V1_HDR_LEN);
+    mbuf->hdr_ver = CL_HDR_V2;
+    mbuf->rsvd    = 0;
+    mbuf->src_id  = v1_to_id(src_id);
+    mbuf->dst_id  = v1_to_id(dst_id);
+    cl_set_legacy_peer(src_id, 1);
+    return ret + V2_HDR_DIFF;
+}
+
+static int sendto_legacy(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len)
+{
+    uint8_t       buf[len];
+    msg_buf_v1_t *v1 = (msg_buf_v1_t *)buf;
+
+    if (len < offsetof(msg_buf_t, buf)
+        || id_to_v1(mbuf->src_id, &v1->src_id) != SUCCESS
+        || id_to_v1(mbuf->dst_id, &v1->dst_id) != SUCCESS) {
+        ERROR("cannot send src:%u dst:%u to legacy peer\n",
+              mbuf->src_id, mbuf->dst_id);
+        return FAILURE;
+    }
+    v1->flags = mbuf->flags;
+    memcpy(v1->info, &mbuf->info, sizeof(v1->info));
+    v1->len     = mbuf->len;
+    v1->max_len = mbuf->max_len;
+    memcpy(v1->buf, mbuf->buf, len - offsetof(msg_buf_t, buf));
+    return CL_SENDTO(mtype, (msg_buf_t *)v1, len - V2_HDR_DIFF);
+}
+
+int cl_init(const cl_mtype_t my_mtype, const uint8_t flags)
 {
     return CL_INIT(my_mtype, flags);
 }
 
-int cl_bind(const long my_mtype)
+int cl_bind(const cl_mtype_t my_mtype)
 {
 #ifdef USE_UNIX_SOCKETS
     return CL_INIT(my_mtype, 0);
@@ -51,26 +160,54 @@ void cl_cleanup(void)
     CL_CLEANUP();
 }
 
-int cl_sendto_q(const long mtype, msg_buf_t *mbuf, uint16_t len)
+int cl_sendto_q(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len)
 {
     if (!mbuf || !len) {
         ERROR("sendto invalid parameters passed buf:%p, buflen:%d\n", mbuf, len);
         return FAILURE;
     }
+    mbuf->hdr_ver = CL_HDR_V2;
+    mbuf->rsvd    = 0;
+    if (is_legacy_peer(GET_ID(mtype))) {
+        return sendto_legacy(mtype, mbuf, len);
+    }
     return CL_SENDTO(mtype, mbuf, len);
 }
 
-int cl_recvfrom_q(const long mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags)
+int cl_recvfrom_q(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags)
 {
+    int ret;
+
     if (!mbuf || !len) {
         ERROR("invalid parameters passed buf:%p, buflen:%d\n", mbuf, len);
         return FAILURE;
     }
     memset(mbuf, 0, sizeof(msg_buf_t));
-    return CL_RECVFROM(mtype, mbuf, len, flags);
+    ret = CL_RECVFROM(mtype, mbuf, len, flags);
+    if (ret <= 0) {
+        return ret;
+    }
+    if (mbuf->hdr_ver != CL_HDR_V2) {
+        return hdr_v1_to_v2(mbuf, ret, len);
+    }
+    /* cmds could be relayed by monitor on behalf of the node */
+    if (!(mbuf->flags & MBUF_IS_CMD)) {
+        cl_set_legacy_peer(mbuf->src_id, 0);
+    }
+    return ret;
+}
+
+/* Time the last frame read with CL_FLAG_TSTAMP was queued, 0 if unknown */
+uint64_t cl_rx_tstamp(void)
+{
+#ifdef USE_UNIX_SOCKETS
+    return usock_rx_tstamp();
+#else
+    return 0;
+#endif
 }
 
-int cl_get_descriptor(const long mtype)
+int cl_get_descriptor(const cl_mtype_t mtype)
 {
 #ifdef USE_UNIX_SOCKETS
     return CL_GET_DESCRIPTOR(mtype);
@@ -22,6 +22,7 @@
 #define _COMMLINE_H_
 
 #include <sys/time.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,16 +41,41 @@ extern "C" {
 #define CL_CREATEQ (1 << 0) //Used by airline
 #define CL_ATTACHQ (1 << 1) //Used by stackline
 
-int  cl_init(const long my_mtype, const uint8_t flags);
-int  cl_bind(const long my_mtype);
+/*
+ * Node ids are 32 bit. mtype carries the commline LINE in the upper 32 bits
+ * and the node id in the lower 32 bits, see MTYPE().
+ */
+typedef uint32_t cl_nodeid_t;
+typedef uint64_t cl_mtype_t;
+
+int  cl_init(const cl_mtype_t my_mtype, const uint8_t flags);
+int  cl_bind(const cl_mtype_t my_mtype);
 void cl_cleanup(void);
 
 //msg_buf_t::flags defined
 #define MBUF_IS_ACK         (1 << 0) //Mbuf is an ACK
 #define MBUF_IS_CMD         (1 << 1) //Mbuf is a cmd
 #define MBUF_DO_NOT_RESPOND (1 << 2) //Cmd does not need a response
+#define MBUF_IS_CTRL        (1 << 3) //Mbuf is a ctrl msg from stackline, type in buf[0]
+#define MBUF_HAS_TRACE      (1 << 4) //Airline internal, never sent: wftrace_rec_t follows buf[len]
+
+//Ctrl msg types (MBUF_IS_CTRL)
+#define CL_CTRL_RADIO_OFF      1 //Stackline radio is off, airline drops rx for it
+#define CL_CTRL_RADIO_ON       2
+#define CL_CTRL_NODE_RESTARTED 3 //Forker respawned the stackline, sent by forker
 //#define	MBUF_OUTPUT_JSON	(1<<2)
 
+/*
+ * msg_buf_t header version 2 carries 32 bit node ids. hdr_ver overlays the
+ * src_id of the legacy (v1) header and is set to CL_HDR_V2, a value that no
+ * legacy stackline uses as its id. flags/info/len/max_len are at the same
+ * offsets in both versions. cl_recvfrom_q() converts v1 frames to v2 and
+ * cl_sendto_q() converts back for peers known to be legacy, so stacklines
+ * built against the old header keep working (for node ids <=
+ * CL_LEGACY_MAX_ID).
+ */
+#define CL_HDR_V2 0xfffd
+
 #pragma pack(push, 1)
 typedef struct _msg_buf_ {
 #ifdef USE_UNIX_SOCKETS
@@ -57,8 +83,8 @@ typedef struct _msg_buf_ {
 #else
     long mtype;
 #endif
-    uint16_t src_id;
-    uint16_t dst_id;
+    uint16_t hdr_ver; // CL_HDR_V2, set by cl_sendto_q()
+    uint16_t rsvd;
     uint8_t  flags;
     union {
         struct {
@@ -72,9 +98,26 @@ typedef struct _msg_buf_ {
             uint8_t status;
         } ack;
     } info;
-    uint16_t len, max_len; // length of the buf only
-    uint8_t  buf[1];
+    uint16_t    len, max_len; // length of the buf only
+    cl_nodeid_t src_id;
+    cl_nodeid_t dst_id;
+    uint8_t     buf[1];
 } msg_buf_t;
+
+/* Legacy (v1) header, only used by the compat shim */
+typedef struct _msg_buf_v1_ {
+#ifdef USE_UNIX_SOCKETS
+    int mtype;
+#else
+    long mtype;
+#endif
+    uint16_t src_id;
+    uint16_t dst_id;
+    uint8_t  flags;
+    uint8_t  info[2];
+    uint16_t len, max_len;
+    uint8_t  buf[1];
+} msg_buf_v1_t;
 #pragma pack(pop)
 
 #define DEFINE_MBUF_SZ(MBUF, SZ)                   \
@@ -88,9 +131,12 @@ typedef struct _msg_buf_ {
 #define MAX_CMD_RSP_SZ 4096
 
 #define CL_FLAG_NOWAIT (1 << 1)
-int cl_recvfrom_q(const long mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags);
-int cl_sendto_q(const long mtype, msg_buf_t *mbuf, uint16_t len);
-int cl_get_descriptor(const long mtype);
+#define CL_FLAG_TSTAMP (1 << 2) //Get the time the frame was queued, see cl_rx_tstamp()
+int      cl_recvfrom_q(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags);
+int      cl_sendto_q(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len);
+int      cl_get_descriptor(const cl_mtype_t mtype);
+void     cl_set_legacy_peer(const cl_nodeid_t id, const int legacy);
+uint64_t cl_rx_tstamp(void);
 
 enum {
     STACKLINE = 1,
@@ -103,12 +149,20 @@ enum {
 //In case of Openthread stackline, the packet already contains the machdr
 //formed. Thus Airline needs to be informed by setting
 //mbuf->dst_id=DSTID_MACHDR_PRESENT.
-#define CL_DSTID_MACHDR_PRESENT 0xfffe
+#define CL_DSTID_MACHDR_PRESENT 0xfffffffe
+
+#define CL_MGR_ID   0xffffffff
+#define CL_BCAST_ID 0xffffffff
+
+//Max node id addressable by legacy (v1 header) stacklines
+#define CL_LEGACY_MAX_ID 0xfffc
 
-#define CL_MGR_ID 0xffff
+#define MTYPE(LINE, ID) (((cl_mtype_t)(LINE) << 32) | (cl_nodeid_t)(ID))
+#define GET_LINE(MT)    ((int)((MT) >> 32))
+#define GET_ID(MT)      ((cl_nodeid_t)(MT))
 
-#define MTYPE(LINE, ID) (((LINE) << 16) | (ID))
-#define GET_LINE(MT)    (MT >> 16)
+//mtype as used by the v1 header i.e. 16 bit LINE and node id
+#define CL_LEGACY_MTYPE(MT) ((GET_LINE(MT) << 16) | (GET_ID(MT) & 0xffff))
 
 #define ms2hh (3600000)
 #define ms2mm (60000)
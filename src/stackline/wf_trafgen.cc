@@ -0,0 +1,598 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       Synthetic traffic generator stackline
+ *
+ * Usage: nodeExec=bin/wf_trafgen $NODEID TG_RATE=2 TG_DST=uniform TG_NODES=100
+ * A stackline with no protocol stack. It sends frames straight to the
+ * airline at a configured rate. Unicast frames wait for the airline's ack
+ * (SendAckToStackline) and at most TG_WINDOW frames are outstanding. A frame
+ * due while the window is full is not generated and is counted as blocked.
+ * Every frame carries its send time, so receivers record the one way
+ * latency. The sender records the ack latency, which is the MAC tx time.
+ * Configuration comes from the nodeExec env tokens, see usage().
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _WF_TRAFGEN_CC_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <math.h>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "commline/commline.h"
+
+using namespace std;
+
+#define TG_MAGIC 0x47544657 // "WFTG"
+
+typedef struct __attribute__((packed)) _tg_hdr_ {
+    uint32_t magic;
+    uint32_t src;
+    uint32_t seq;
+    uint32_t rsvd;
+    uint64_t t_tx_ns; // CLOCK_MONOTONIC, shared by all processes on the host
+} tg_hdr_t;
+
+/* log2 usec buckets with 8 linear sub buckets, ~12% resolution */
+#define HIST_SUB     8
+#define HIST_BUCKETS (40 * HIST_SUB)
+
+class Hist {
+public:
+    uint64_t n = 0, sum = 0;
+    uint32_t cnt[HIST_BUCKETS] = { 0 };
+
+    static int idx(uint64_t v)
+    {
+        int e;
+
+        if (v < HIST_SUB) {
+            return v;
+        }
+        e = 63 - __builtin_clzll(v);
+        if (e > 41) {
+            return HIST_BUCKETS - 1;
+        }
+        return (e - 2) * HIST_SUB + ((v >> (e - 3)) & (HIST_SUB - 1));
+    };
+    static uint64_t val(int i)
+    {
+        int e = i / HIST_SUB + 2;
+
+        if (i < HIST_SUB) {
+            return i;
+        }
+        return (1ULL << e) | ((uint64_t)(i % HIST_SUB) << (e - 3));
+    };
+    void add(uint64_t us)
+    {
+        cnt[idx(us)]++;
+        n++;
+        sum += us;
+    };
+    uint64_t pct(double p)
+    {
+        uint64_t want = n * p, s = 0;
+
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+            s += cnt[i];
+            if (s > want) {
+                return val(i);
+            }
+        }
+        return 0;
+    };
+    /* Sparse [[bucket_low_us,count],...] so that nodes can be merged */
+    int json(char *buf, int buflen)
+    {
+        int len = snprintf(buf, buflen, "{\"n\":%" PRIu64 ",\"sum\":%" PRIu64 ",\"hist\":[", n, sum);
+
+        for (int i = 0; i < HIST_BUCKETS && len < buflen; i++) {
+            if (cnt[i]) {
+                len += snprintf(buf + len, buflen - len, "%s[%" PRIu64 ",%u]",
+                                buf[len - 1] == '[' ? "" : ",", val(i), cnt[i]);
+            }
+        }
+        if (len < buflen) {
+            len += snprintf(buf + len, buflen - len, "]}");
+        }
+        return len;
+    };
+};
+
+typedef struct _tg_stats_ {
+    uint64_t tx_ucast, tx_bcast, blocked;
+    uint64_t ack_ok, no_ack, ack_err, ack_timeout, retries;
+    uint64_t rx_ucast, rx_bcast, rx_other;
+} tg_stats_t;
+
+/* A timed out frame stays queued as a tombstone until its late ack shows
+ * up, so that the ack is not credited to the next frame to that dst */
+typedef struct _tg_pending_ {
+    cl_nodeid_t dst;
+    uint64_t    t_ns;
+    bool        timedout;
+} tg_pending_t;
+
+#define TG_TOMBSTONE_TMO_MULT 8 // tombstones whose ack never came are dropped
+
+enum {
+    DST_FIXED,
+    DST_RANGE,
+    DST_ZIPF,
+    DST_NBR,
+};
+
+static cl_nodeid_t           g_id;
+static volatile sig_atomic_t g_stop;
+static tg_stats_t            g_st;
+static Hist                  g_lat, g_ack;
+static deque<tg_pending_t>   g_pending;
+static int                   g_inflight; // g_pending entries not timed out
+static mt19937_64            g_rng;
+
+/* Configuration */
+static double      g_rate, g_bcast;
+static int         g_poisson, g_window, g_size_min, g_size_max, g_dst_mode, g_radio_off;
+static cl_nodeid_t g_dst_lo, g_dst_hi;
+static uint64_t    g_count, g_start_ns, g_ack_tmo_ns, g_report_ns;
+static const char *g_stats_file;
+static vector<double> g_zipf_cdf;
+static vector<cl_nodeid_t> g_nbrs; // nodes heard from, for TG_DST=nbr
+static unordered_set<cl_nodeid_t> g_nbr_set;
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static const char *env(const char *name, const char *def)
+{
+    const char *val = getenv(name);
+
+    return val && *val ? val : def;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s <nodeid>, configured by env (nodeExec key=value tokens):\n"
+            "  TG_RATE=<frames/sec>          0 only receives, default 1\n"
+            "  TG_ARRIVAL=const|poisson      default const\n"
+            "  TG_BCAST=<0..1>               fraction of frames broadcast, default 0\n"
+            "  TG_SIZE=<bytes>|<min>-<max>   payload size, default 50\n"
+            "  TG_DST=<id>|<lo>-<hi>|uniform|zipf[:<s>]|nbr\n"
+            "                                unicast destination, default 0. nbr picks\n"
+            "                                a node heard from, broadcasts till then\n"
+            "  TG_NODES=<n>                  node ids for uniform/zipf\n"
+            "  TG_WINDOW=<n>                 outstanding unacked frames, default 1\n"
+            "  TG_ACK_TIMEOUT=<ms>           default 2000\n"
+            "  TG_COUNT=<n>                  stop after n frames are sent\n"
+            "  TG_START=<ms>                 delay before the first frame\n"
+            "  TG_SEED=<n>                   default 0xbabe, mixed with the node id\n"
+            "  TG_REPORT=<sec>               print the stats every sec\n"
+            "  TG_RADIO=on|off               off keeps the radio off, default on\n"
+            "  TG_STATS=<file>               append a JSON line at exit\n",
+            prog);
+}
+
+static int parseDst(void)
+{
+    string      dst   = env("TG_DST", "0");
+    cl_nodeid_t nodes = strtoul(env("TG_NODES", "0"), NULL, 0);
+    double      s;
+
+    if (dst == "nbr") {
+        g_dst_mode = DST_NBR;
+        return SUCCESS;
+    }
+    if (dst == "uniform" || !dst.compare(0, 4, "zipf")) {
+        if (nodes < 2) {
+            fprintf(stderr, "TG_DST=%s needs TG_NODES\n", dst.c_str());
+            return FAILURE;
+        }
+        g_dst_mode = DST_RANGE;
+        g_dst_lo   = 0;
+        g_dst_hi   = nodes - 1;
+        if (dst[0] == 'z') {
+            // rank r (node id r) is picked with probability ~ 1/(r+1)^s
+            s          = dst.size() > 5 ? atof(dst.c_str() + 5) : 1.0;
+            g_dst_mode = DST_ZIPF;
+            g_zipf_cdf.resize(nodes);
+            for (cl_nodeid_t r = 0; r < nodes; r++) {
+                g_zipf_cdf[r] = (r ? g_zipf_cdf[r - 1] : 0) + 1.0 / pow(r + 1, s);
+            }
+        }
+        return SUCCESS;
+    }
+    g_dst_mode = DST_FIXED;
+    g_dst_lo = g_dst_hi = strtoul(dst.c_str(), NULL, 0);
+    if (dst.find('-') != string::npos) {
+        g_dst_mode = DST_RANGE;
+        g_dst_hi   = strtoul(dst.c_str() + dst.find('-') + 1, NULL, 0);
+    }
+    if (g_dst_hi < g_dst_lo || (g_dst_lo == g_dst_hi && g_dst_lo == g_id && g_rate > 0 && g_bcast < 1)) {
+        fprintf(stderr, "invalid TG_DST=%s for node %u\n", dst.c_str(), g_id);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+static int parseCfg(void)
+{
+    const char *size = env("TG_SIZE", "50"), *dash;
+
+    g_rate      = atof(env("TG_RATE", "1"));
+    g_poisson   = !strcmp(env("TG_ARRIVAL", "const"), "poisson");
+    g_bcast     = atof(env("TG_BCAST", "0"));
+    g_window    = atoi(env("TG_WINDOW", "1"));
+    g_count     = strtoull(env("TG_COUNT", "0"), NULL, 0);
+    g_start_ns  = strtoull(env("TG_START", "0"), NULL, 0) * 1000000;
+    g_ack_tmo_ns = strtoull(env("TG_ACK_TIMEOUT", "2000"), NULL, 0) * 1000000;
+    g_report_ns = strtoull(env("TG_REPORT", "0"), NULL, 0) * 1000000000;
+    g_stats_file = getenv("TG_STATS");
+    g_radio_off = !strcmp(env("TG_RADIO", "on"), "off");
+    g_size_min = g_size_max = atoi(size);
+    dash = strchr(size, '-');
+    if (dash) {
+        g_size_max = atoi(dash + 1);
+    }
+    if (g_size_min < (int)sizeof(tg_hdr_t)) {
+        g_size_min = sizeof(tg_hdr_t); // the frame must carry its header
+    }
+    if (g_rate < 0 || g_bcast < 0 || g_bcast > 1 || g_window < 1 ||
+        g_size_max < g_size_min || g_size_max > COMMLINE_MAX_BUF) {
+        fprintf(stderr, "invalid TG_RATE/TG_BCAST/TG_WINDOW/TG_SIZE\n");
+        return FAILURE;
+    }
+    g_rng.seed(strtoull(env("TG_SEED", "0xbabe"), NULL, 0) ^ ((uint64_t)g_id << 32 | g_id));
+    return parseDst();
+}
+
+static cl_nodeid_t pickDst(void)
+{
+    cl_nodeid_t dst;
+
+    if (g_dst_mode == DST_NBR) {
+        return g_nbrs[uniform_int_distribution<size_t>(0, g_nbrs.size() - 1)(g_rng)];
+    }
+    do {
+        if (g_dst_mode == DST_ZIPF) {
+            uniform_real_distribution<double> u(0, g_zipf_cdf.back());
+            dst = lower_bound(g_zipf_cdf.begin(), g_zipf_cdf.end(), u(g_rng)) - g_zipf_cdf.begin();
+        } else {
+            dst = uniform_int_distribution<cl_nodeid_t>(g_dst_lo, g_dst_hi)(g_rng);
+        }
+    } while (dst == g_id && g_dst_mode != DST_FIXED);
+    return dst;
+}
+
+static uint64_t nextGap(void)
+{
+    if (g_poisson) {
+        return exponential_distribution<double>(g_rate)(g_rng) * 1e9;
+    }
+    return 1e9 / g_rate;
+}
+
+/* TG_COUNT counts the frames sent, blocked ones do not use it up */
+static bool countReached(void)
+{
+    return g_count && g_st.tx_ucast + g_st.tx_bcast >= g_count;
+}
+
+static void txFrame(uint64_t now)
+{
+    static uint32_t seq;
+    DEFINE_MBUF(mbuf);
+    tg_hdr_t *      h     = (tg_hdr_t *)mbuf->buf;
+    bool            bcast = g_bcast > 0 && uniform_real_distribution<double>(0, 1)(g_rng) < g_bcast;
+
+    if (g_dst_mode == DST_NBR && g_nbrs.empty()) {
+        bcast = true;
+    }
+
+    if (!bcast && g_inflight >= g_window) {
+        g_st.blocked++;
+        return;
+    }
+    mbuf->src_id = g_id;
+    mbuf->dst_id = bcast ? CL_BCAST_ID : pickDst();
+    mbuf->len    = uniform_int_distribution<int>(g_size_min, g_size_max)(g_rng);
+    h->magic     = TG_MAGIC;
+    h->src       = g_id;
+    h->seq       = seq++;
+    h->t_tx_ns   = now;
+    for (int i = sizeof(*h); i < mbuf->len; i++) {
+        mbuf->buf[i] = i;
+    }
+    if (cl_sendto_q(MTYPE(AIRLINE, CL_MGR_ID), mbuf, sizeof(msg_buf_t) + mbuf->len) != SUCCESS) {
+        ERROR("tx to airline failed\n");
+        return;
+    }
+    if (bcast) {
+        g_st.tx_bcast++;
+        return;
+    }
+    g_st.tx_ucast++;
+    g_pending.push_back({ mbuf->dst_id, now, false });
+    g_inflight++;
+}
+
+/* Marks the frames not acked within the timeout. Returns the time the next
+ * in-flight frame times out, 0 if none. */
+static uint64_t expireAcks(uint64_t now)
+{
+    while (!g_pending.empty() && g_pending.front().timedout &&
+           now - g_pending.front().t_ns > g_ack_tmo_ns * TG_TOMBSTONE_TMO_MULT) {
+        g_pending.pop_front();
+    }
+    for (auto &p : g_pending) {
+        if (p.timedout) {
+            continue;
+        }
+        if (now - p.t_ns <= g_ack_tmo_ns) {
+            return p.t_ns + g_ack_tmo_ns + 1;
+        }
+        p.timedout = true;
+        g_inflight--;
+        g_st.ack_timeout++;
+    }
+    return 0;
+}
+
+/* The ack carries only the dst. The airline acks a node's unicast frames
+ * in the order they were sent, so it belongs to the oldest frame pending
+ * for that dst. */
+static void rxAck(msg_buf_t *mbuf, uint64_t now)
+{
+    auto it = find_if(g_pending.begin(), g_pending.end(),
+                      [mbuf](const tg_pending_t &p) { return p.dst == mbuf->dst_id; });
+
+    if (it == g_pending.end()) {
+        return;
+    }
+    if (it->timedout) {
+        g_pending.erase(it); // late ack, already counted as timeout
+        return;
+    }
+    g_ack.add((now - it->t_ns) / 1000);
+    g_pending.erase(it);
+    g_inflight--;
+    switch (mbuf->info.ack.status) {
+    case WF_STATUS_ACK_OK:
+        g_st.ack_ok++;
+        g_st.retries += mbuf->info.ack.retries ? mbuf->info.ack.retries - 1 : 0;
+        break;
+    case WF_STATUS_NO_ACK:
+        g_st.no_ack++;
+        break;
+    default:
+        g_st.ack_err++;
+        break;
+    }
+}
+
+static void rxData(msg_buf_t *mbuf, uint64_t now)
+{
+    tg_hdr_t h;
+
+    if (mbuf->len < sizeof(h)) {
+        g_st.rx_other++;
+        return;
+    }
+    memcpy(&h, mbuf->buf, sizeof(h));
+    if (h.magic != TG_MAGIC || now < h.t_tx_ns) {
+        g_st.rx_other++;
+        return;
+    }
+    if (g_dst_mode == DST_NBR && h.src != g_id && g_nbr_set.insert(h.src).second) {
+        g_nbrs.push_back(h.src);
+    }
+    if (mbuf->dst_id == CL_BCAST_ID) {
+        g_st.rx_bcast++;
+    } else {
+        g_st.rx_ucast++;
+    }
+    g_lat.add((now - h.t_tx_ns) / 1000);
+}
+
+static int statsStr(char *buf, int buflen)
+{
+    return snprintf(buf, buflen,
+                    "TG: id=%u tx_ucast=%" PRIu64 " tx_bcast=%" PRIu64 " blocked=%" PRIu64
+                    " ack_ok=%" PRIu64 " no_ack=%" PRIu64 " ack_err=%" PRIu64 " ack_timeout=%" PRIu64
+                    " retries=%" PRIu64 " rx_ucast=%" PRIu64 " rx_bcast=%" PRIu64 " rx_other=%" PRIu64
+                    " lat_p50_us=%" PRIu64 " lat_p99_us=%" PRIu64 " ack_p50_us=%" PRIu64
+                    " ack_p99_us=%" PRIu64,
+                    g_id, g_st.tx_ucast, g_st.tx_bcast, g_st.blocked, g_st.ack_ok, g_st.no_ack,
+                    g_st.ack_err, g_st.ack_timeout, g_st.retries, g_st.rx_ucast, g_st.rx_bcast,
+                    g_st.rx_other, g_lat.pct(0.5), g_lat.pct(0.99), g_ack.pct(0.5), g_ack.pct(0.99));
+}
+
+static void handleCmd(msg_buf_t *mbuf)
+{
+    DEFINE_MBUF_SZ(rsp, MAX_CMD_RSP_SZ);
+    char cmd[256];
+
+    snprintf(cmd, sizeof(cmd), "%.*s", mbuf->len, mbuf->buf);
+    rsp->src_id = mbuf->src_id;
+    rsp->dst_id = mbuf->dst_id;
+    rsp->flags  = mbuf->flags;
+    if (!strcmp(cmd, "cmd_trafgen_stats")) {
+        rsp->len = statsStr((char *)rsp->buf, rsp->max_len);
+    } else if (!strcmp(cmd, "cmd_node_osname")) {
+        rsp->len = snprintf((char *)rsp->buf, rsp->max_len, "wf_trafgen");
+    } else {
+        rsp->len = snprintf((char *)rsp->buf, rsp->max_len, "SL_INVALID_CMD(%s)", cmd);
+    }
+    cl_sendto_q(MTYPE(MONITOR, CL_MGR_ID), rsp, rsp->len + sizeof(msg_buf_t));
+}
+
+static void dumpStats(void)
+{
+    char buf[8192];
+    int  len, fd;
+
+    statsStr(buf, sizeof(buf));
+    printf("%s\n", buf);
+    fflush(stdout);
+    if (!g_stats_file) {
+        return;
+    }
+    len = snprintf(buf, sizeof(buf),
+                   "{\"id\":%u,\"tx_ucast\":%" PRIu64 ",\"tx_bcast\":%" PRIu64 ",\"blocked\":%" PRIu64
+                   ",\"ack_ok\":%" PRIu64 ",\"no_ack\":%" PRIu64 ",\"ack_err\":%" PRIu64
+                   ",\"ack_timeout\":%" PRIu64 ",\"retries\":%" PRIu64 ",\"rx_ucast\":%" PRIu64
+                   ",\"rx_bcast\":%" PRIu64 ",\"rx_other\":%" PRIu64 ",\"lat_us\":",
+                   g_id, g_st.tx_ucast, g_st.tx_bcast, g_st.blocked, g_st.ack_ok, g_st.no_ack,
+                   g_st.ack_err, g_st.ack_timeout, g_st.retries, g_st.rx_ucast, g_st.rx_bcast,
+                   g_st.rx_other);
+    len += g_lat.json(buf + len, sizeof(buf) - len - 64);
+    len += snprintf(buf + len, sizeof(buf) - len, ",\"ack_us\":");
+    len += g_ack.json(buf + len, sizeof(buf) - len - 8);
+    len += snprintf(buf + len, sizeof(buf) - len, "}\n");
+    // one write() per node so that the lines of many nodes do not mix
+    fd = open(g_stats_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0 || write(fd, buf, len) != len) {
+        ERROR("could not write stats to %s\n", g_stats_file);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+/* Same ctrl msg as cl_set_radio(), whose object file needs the cmd_*
+ * handlers of a protocol stack */
+static int radioOff(void)
+{
+    DEFINE_MBUF_SZ(mbuf, 1);
+
+    mbuf->src_id = g_id;
+    mbuf->dst_id = CL_MGR_ID;
+    mbuf->flags  = MBUF_IS_CTRL;
+    mbuf->buf[0] = CL_CTRL_RADIO_OFF;
+    mbuf->len    = 1;
+    return cl_sendto_q(MTYPE(AIRLINE, CL_MGR_ID), mbuf, sizeof(msg_buf_t) + mbuf->len);
+}
+
+static void sigHandler(int sig)
+{
+    g_stop = 1;
+}
+
+int main(int argc, char *argv[])
+{
+    DEFINE_MBUF(mbuf);
+    struct pollfd pfd;
+    uint64_t      now, next_tx, next_report, wake, ack_wake;
+    int           tmo;
+
+    if (argc < 2 || !strcmp(argv[1], "-h")) {
+        usage(argv[0]);
+        return 1;
+    }
+    g_id = strtoul(argv[1], NULL, 0);
+    if (parseCfg() != SUCCESS) {
+        return 1;
+    }
+    if (cl_init(MTYPE(STACKLINE, g_id), CL_ATTACHQ) != SUCCESS) {
+        ERROR("commline init failed for node %u\n", g_id);
+        return 1;
+    }
+    if (g_radio_off && radioOff() != SUCCESS) {
+        ERROR("radio off failed for node %u\n", g_id);
+    }
+    signal(SIGINT, sigHandler);
+    signal(SIGTERM, sigHandler);
+    pfd.fd     = cl_get_descriptor(MTYPE(STACKLINE, g_id));
+    pfd.events = POLLIN;
+
+    now = nowNs();
+    // random phase so that nodes started together do not send together
+    next_tx = now + g_start_ns + (g_rate > 0 ? uniform_int_distribution<uint64_t>(0, 1e9 / g_rate)(g_rng) : 0);
+    next_report = now + g_report_ns;
+    INFO("wf_trafgen node %u rate=%.3f bcast=%.2f size=%d-%d window=%d\n",
+         g_id, g_rate, g_bcast, g_size_min, g_size_max, g_window);
+
+    while (!g_stop) {
+        now = nowNs();
+        ack_wake = expireAcks(now);
+        if (g_rate > 0 && now >= next_tx && !countReached()) {
+            if (now - next_tx > 1000000000) {
+                next_tx = now; // do not burst to catch up after a stall
+            }
+            txFrame(now);
+            next_tx += nextGap();
+        }
+        if (g_report_ns && now >= next_report) {
+            dumpStats();
+            next_report = now + g_report_ns;
+        }
+
+        wake = now + 1000000000;
+        if (g_rate > 0 && !countReached()) {
+            wake = min(wake, next_tx);
+        }
+        if (ack_wake) {
+            wake = min(wake, ack_wake);
+        }
+        if (g_report_ns) {
+            wake = min(wake, next_report);
+        }
+        tmo = wake > now ? (wake - now + 999999) / 1000000 : 0;
+        if (pfd.fd < 0) {
+            tmo = min(tmo, 1); // msgq, nothing to poll
+        }
+        if (poll(&pfd, pfd.fd < 0 ? 0 : 1, tmo) < 0) {
+            continue; // EINTR
+        }
+        while (1) {
+            if (cl_recvfrom_q(MTYPE(STACKLINE, g_id), mbuf, sizeof(mbuf_buf), CL_FLAG_NOWAIT) <= 0) {
+                break;
+            }
+            now = nowNs();
+            if (mbuf->flags & MBUF_IS_CMD) {
+                handleCmd(mbuf);
+            } else if (mbuf->flags & MBUF_IS_ACK) {
+                rxAck(mbuf, now);
+            } else {
+                rxData(mbuf, now);
+            }
+        }
+    }
+    dumpStats();
+    cl_cleanup();
+    return 0;
+}
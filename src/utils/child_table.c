@@ -0,0 +1,480 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       Stackline process table and reaper thread in forker
+ *
+ * The table grows with the highest node id spawned. Entries are allocated
+ * once and never freed so that pointers handed out remain valid. Every child
+ * gets a pidfd registered with the reaper's epoll set, so an exiting
+ * stackline is reaped and recorded without any SIGCHLD handling. On kernels
+ * without pidfd_open the reaper falls back to polling waitpid(), as it does
+ * for a child whose pidfd could not be added to the epoll set.
+ * The entry fields are shared with the other forker threads, access them
+ * under g_child_lock.
+ *
+ * A stackline spawned with a WF_RESTART= policy is respawned by the reaper
+ * with its original command after a backoff that doubles with every restart.
+ * The airline is then sent CL_CTRL_NODE_RESTARTED so it can reset the node.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _CHILD_TABLE_C_
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include "commline/commline.h"
+#include "utils/forker_common.h"
+
+static child_psinfo_t **g_child_tbl;
+static uint32_t         g_child_tbl_sz;  // allocated slots
+static uint32_t         g_child_tbl_cnt; // highest node id + 1
+static pthread_mutex_t  g_child_lock   = PTHREAD_MUTEX_INITIALIZER;
+static int              g_reap_epollfd = -1;
+static int              g_no_pidfd;
+static uint32_t         g_unwatched; // children without a pidfd in the epoll set
+static int              g_stopping;
+
+#define RESTART_BACKOFF_MS     1000
+#define RESTART_BACKOFF_MAX_MS 60000
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+static int pidfd_open(pid_t pid)
+{
+    return syscall(SYS_pidfd_open, pid, 0);
+}
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* policy: never|on-failure|always[,max=<n>][,backoff=<ms>] */
+int child_set_restart(child_psinfo_t *ci, const char *policy)
+{
+    char  buf[128], *tok, *saveptr = NULL;
+    int   ret = SUCCESS;
+
+    ci->restart_policy     = RESTART_NEVER;
+    ci->restart_max        = 0;
+    ci->restart_backoff_ms = RESTART_BACKOFF_MS;
+    if (!policy) {
+        return SUCCESS;
+    }
+    snprintf(buf, sizeof(buf), "%s", policy);
+    for (tok = strtok_r(buf, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+        if (!strcmp(tok, "never")) {
+            ci->restart_policy = RESTART_NEVER;
+        } else if (!strcmp(tok, "on-failure")) {
+            ci->restart_policy = RESTART_ON_FAILURE;
+        } else if (!strcmp(tok, "always")) {
+            ci->restart_policy = RESTART_ALWAYS;
+        } else if (!strncmp(tok, "max=", 4)) {
+            ci->restart_max = strtoul(tok + 4, NULL, 10);
+        } else if (!strncmp(tok, "backoff=", 8)) {
+            ci->restart_backoff_ms = strtoul(tok + 8, NULL, 10);
+        } else {
+            ERROR("node:%u unknown restart option [%s]\n", ci->nodeid, tok);
+            ret = FAILURE;
+        }
+    }
+    return ret;
+}
+
+uint32_t child_count(void)
+{
+    return g_child_tbl_cnt;
+}
+
+child_psinfo_t *child_get(cl_nodeid_t nodeid, int create)
+{
+    child_psinfo_t *ci = NULL;
+
+    pthread_mutex_lock(&g_child_lock);
+    if (nodeid >= g_child_tbl_sz) {
+        child_psinfo_t **tbl;
+        uint32_t         sz = g_child_tbl_sz ? g_child_tbl_sz : 64;
+
+        if (!create) {
+            goto unlock;
+        }
+        while (sz <= nodeid) {
+            sz *= 2;
+        }
+        tbl = realloc(g_child_tbl, sz * sizeof(*tbl));
+        if (!tbl) {
+            ERROR("child table realloc failed sz:%u\n", sz);
+            goto unlock;
+        }
+        memset(tbl + g_child_tbl_sz, 0, (sz - g_child_tbl_sz) * sizeof(*tbl));
+        g_child_tbl    = tbl;
+        g_child_tbl_sz = sz;
+    }
+    ci = g_child_tbl[nodeid];
+    if (!ci && create) {
+        ci = calloc(1, sizeof(*ci));
+        if (ci) {
+            ci->pidfd  = -1;
+            ci->master = -1;
+            ci->nodeid = nodeid;
+        }
+        g_child_tbl[nodeid] = ci;
+        if (nodeid >= g_child_tbl_cnt) {
+            g_child_tbl_cnt = nodeid + 1;
+        }
+    }
+unlock:
+    pthread_mutex_unlock(&g_child_lock);
+    return ci;
+}
+
+/* Called with g_child_lock held */
+static void child_sched_respawn(child_psinfo_t *ci)
+{
+    uint64_t backoff;
+    int      failed = WIFSIGNALED(ci->exit_status) || WEXITSTATUS(ci->exit_status);
+
+    if (g_stopping || !ci->cmd || ci->restart_policy == RESTART_NEVER ||
+        (ci->restart_policy == RESTART_ON_FAILURE && !failed)) {
+        return;
+    }
+    if (ci->restart_max && ci->auto_restarts >= ci->restart_max) {
+        ERROR("node:%u reached max restarts:%u, not respawning\n", ci->nodeid, ci->restart_max);
+        return;
+    }
+    backoff = (uint64_t)ci->restart_backoff_ms << (ci->auto_restarts < 6 ? ci->auto_restarts : 6);
+    if (backoff > RESTART_BACKOFF_MAX_MS) {
+        backoff = RESTART_BACKOFF_MAX_MS;
+    }
+    INFO("node:%u respawn in %" PRIu64 "ms\n", ci->nodeid, backoff);
+    ci->respawn_at_ms = now_ms() + backoff;
+}
+
+static void child_notify_airline(cl_nodeid_t nodeid)
+{
+    DEFINE_MBUF(mbuf);
+
+    mbuf->src_id = nodeid;
+    mbuf->dst_id = CL_MGR_ID;
+    mbuf->flags  = MBUF_IS_CTRL;
+    mbuf->len    = 1;
+    mbuf->buf[0] = CL_CTRL_NODE_RESTARTED;
+    cl_sendto_q(MTYPE(AIRLINE, CL_MGR_ID), mbuf, sizeof(msg_buf_t) + mbuf->len);
+}
+
+/* Respawns the children whose backoff has elapsed. Returns the epoll_wait
+ * timeout till the next pending respawn. */
+static int child_respawn_due(void)
+{
+    uint32_t        i;
+    uint64_t        now = now_ms(), next = 0;
+    child_psinfo_t *ci;
+    char *          cmd;
+
+    for (i = 0; i < g_child_tbl_cnt; i++) {
+        pthread_mutex_lock(&g_child_lock);
+        ci  = g_child_tbl[i];
+        cmd = NULL;
+        if (ci && ci->respawn_at_ms) {
+            if (ci->respawn_at_ms <= now && !g_stopping) {
+                ci->respawn_at_ms = 0;
+                cmd               = strdup(ci->cmd);
+            } else if (!next || ci->respawn_at_ms < next) {
+                next = ci->respawn_at_ms;
+            }
+        }
+        pthread_mutex_unlock(&g_child_lock);
+        if (!cmd) {
+            continue;
+        }
+        if (SUCCESS == fork_n_exec(ci->nodeid, cmd)) {
+            pthread_mutex_lock(&g_child_lock);
+            ci->auto_restarts++;
+            pthread_mutex_unlock(&g_child_lock);
+            child_notify_airline(ci->nodeid);
+        }
+        free(cmd);
+    }
+    if (!next) {
+        return -1;
+    }
+    return next > now ? (int)(next - now) : 0;
+}
+
+static void child_exited(child_psinfo_t *ci, int status)
+{
+    pthread_mutex_lock(&g_child_lock);
+    if (ci->pidfd >= 0) {
+        epoll_ctl(g_reap_epollfd, EPOLL_CTL_DEL, ci->pidfd, NULL);
+        CLOSE(ci->pidfd);
+    } else if (!g_no_pidfd) {
+        g_unwatched--;
+    }
+    ci->pid         = 0;
+    ci->exit_status = status;
+    ci->exit_time   = time(NULL);
+    ci->exits++;
+
+    if (WIFSIGNALED(status)) {
+        ERROR("node:%u exited on signal %d\n", ci->nodeid, WTERMSIG(status));
+    } else {
+        INFO("node:%u exited with status %d\n", ci->nodeid, WEXITSTATUS(status));
+    }
+    child_sched_respawn(ci);
+    pthread_mutex_unlock(&g_child_lock);
+}
+
+void child_lock(void)
+{
+    pthread_mutex_lock(&g_child_lock);
+}
+
+void child_unlock(void)
+{
+    pthread_mutex_unlock(&g_child_lock);
+}
+
+pid_t child_pid(child_psinfo_t *ci)
+{
+    pid_t pid;
+
+    pthread_mutex_lock(&g_child_lock);
+    pid = ci->pid;
+    pthread_mutex_unlock(&g_child_lock);
+    return pid;
+}
+
+/* Reaps the children not watched via pidfd, called with g_child_lock held */
+static int child_poll_unwatched(child_psinfo_t **exited, int *status, int max)
+{
+    uint32_t i;
+    int      n = 0;
+
+    for (i = 0; i < g_child_tbl_cnt && n < max; i++) {
+        child_psinfo_t *ci = g_child_tbl[i];
+
+        if (ci && ci->pid > 0 && ci->pidfd < 0 &&
+            waitpid(ci->pid, &status[n], WNOHANG) == ci->pid) {
+            exited[n++] = ci;
+        }
+    }
+    return n;
+}
+
+static child_psinfo_t *child_by_pid(pid_t pid)
+{
+    uint32_t i;
+
+    for (i = 0; i < g_child_tbl_cnt; i++) {
+        if (g_child_tbl[i] && g_child_tbl[i]->pid == pid) {
+            return g_child_tbl[i];
+        }
+    }
+    return NULL;
+}
+
+int child_add(child_psinfo_t *ci)
+{
+    struct epoll_event ev;
+
+    pthread_mutex_lock(&g_child_lock);
+    if (ci->start_time) {
+        ci->restarts++;
+    }
+    ci->start_time = time(NULL);
+    ci->pidfd      = g_no_pidfd ? -1 : pidfd_open(ci->pid);
+    if (ci->pidfd < 0) {
+        if (!g_no_pidfd) {
+            WARN("pidfd_open unavailable (%m), polling for child exits\n");
+            g_no_pidfd = 1;
+        }
+        pthread_mutex_unlock(&g_child_lock);
+        return SUCCESS;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN;
+    ev.data.u32 = ci->nodeid;
+    if (epoll_ctl(g_reap_epollfd, EPOLL_CTL_ADD, ci->pidfd, &ev) == -1) {
+        ERROR("epoll_ctl failed nodeid:%u pidfd:%d %m, polling for its exit\n",
+              ci->nodeid, ci->pidfd);
+        CLOSE(ci->pidfd);
+        g_unwatched++;
+    }
+    pthread_mutex_unlock(&g_child_lock);
+    return SUCCESS;
+}
+
+#define MAXEVENTS 32
+static void *reaper_thread(void *arg)
+{
+    int                n, i, status, timeout, polling, st[MAXEVENTS];
+    pid_t              pid;
+    child_psinfo_t *   ci, *exited[MAXEVENTS];
+    struct epoll_event events[MAXEVENTS];
+
+    for (;;) {
+        timeout = child_respawn_due();
+        pthread_mutex_lock(&g_child_lock);
+        polling = g_no_pidfd || g_unwatched;
+        pthread_mutex_unlock(&g_child_lock);
+        /* Also wakes up periodically to pick up newly unwatched children */
+        if (timeout < 0 || timeout > (polling ? 100 : 1000)) {
+            timeout = polling ? 100 : 1000;
+        }
+        n = epoll_wait(g_reap_epollfd, events, MAXEVENTS, timeout);
+        for (i = 0; i < n; i++) {
+            ci  = child_get(events[i].data.u32, 0);
+            pid = ci ? child_pid(ci) : 0;
+            if (pid > 0 && waitpid(pid, &status, WNOHANG) == pid) {
+                child_exited(ci, status);
+            }
+        }
+        if (!polling) {
+            continue;
+        }
+        if (!g_no_pidfd) {
+            pthread_mutex_lock(&g_child_lock);
+            n = child_poll_unwatched(exited, st, MAXEVENTS);
+            pthread_mutex_unlock(&g_child_lock);
+            for (i = 0; i < n; i++) {
+                child_exited(exited[i], st[i]);
+            }
+            continue;
+        }
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            pthread_mutex_lock(&g_child_lock);
+            ci = child_by_pid(pid);
+            pthread_mutex_unlock(&g_child_lock);
+            if (ci) {
+                child_exited(ci, status);
+            }
+        }
+    }
+    return NULL;
+}
+
+int start_reaper_thread(void)
+{
+    pthread_t tid;
+
+    g_reap_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_reap_epollfd < 0) {
+        ERROR("failed creating epollfd %m\n");
+        return FAILURE;
+    }
+    if (pthread_create(&tid, NULL, reaper_thread, NULL)) {
+        ERROR("failure creating reaper thread %m\n");
+        CLOSE(g_reap_epollfd);
+        return FAILURE;
+    }
+    pthread_detach(tid);
+    return SUCCESS;
+}
+
+void child_killall(int signum)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&g_child_lock);
+    g_stopping = 1;
+    for (i = 0; i < g_child_tbl_cnt; i++) {
+        if (g_child_tbl[i] && g_child_tbl[i]->pid > 0) {
+            kill(g_child_tbl[i]->pid, signum);
+        }
+    }
+    pthread_mutex_unlock(&g_child_lock);
+}
+
+static int child_status_str(child_psinfo_t *ci, char *buf, int buflen)
+{
+    const char *state = ci->pid > 0 ? "running" : "exited";
+    int         code  = 0;
+
+    if (ci->pid <= 0 && ci->exits) {
+        if (WIFSIGNALED(ci->exit_status)) {
+            state = "killed";
+            code  = WTERMSIG(ci->exit_status);
+        } else {
+            code = WEXITSTATUS(ci->exit_status);
+        }
+    }
+    if (ci->pid <= 0 && ci->respawn_at_ms) {
+        state = "respawning";
+    }
+    return snprintf(buf, buflen, "%u: pid=%d state=%s code=%d exits=%u restarts=%u\n",
+                    ci->nodeid, ci->pid, state, code, ci->exits, ci->restarts);
+}
+
+/* Without a node id, lists the summary followed by every node that is not
+ * running. The list is truncated with "..." if it does not fit. */
+int cmd_node_status(cl_nodeid_t nodeid, char *buf, int buflen)
+{
+    child_psinfo_t *ci;
+    uint32_t        i, total = 0, running = 0, exits = 0, restarts = 0;
+    int             n = 0, len;
+
+    pthread_mutex_lock(&g_child_lock);
+    if (nodeid != CL_MGR_ID) {
+        ci = nodeid < g_child_tbl_cnt ? g_child_tbl[nodeid] : NULL;
+        n  = ci ? child_status_str(ci, buf, buflen) : snprintf(buf, buflen, "NODE_NOT_SPAWNED");
+        pthread_mutex_unlock(&g_child_lock);
+        return n;
+    }
+    for (i = 0; i < g_child_tbl_cnt; i++) {
+        ci = g_child_tbl[i];
+        if (!ci) {
+            continue;
+        }
+        total++;
+        running += ci->pid > 0;
+        exits += ci->exits;
+        restarts += ci->restarts;
+    }
+    n = snprintf(buf, buflen, "nodes=%u running=%u exited=%u exits=%u restarts=%u\n",
+                 total, running, total - running, exits, restarts);
+    for (i = 0; i < g_child_tbl_cnt && n < buflen; i++) {
+        ci = g_child_tbl[i];
+        if (!ci || ci->pid > 0) {
+            continue;
+        }
+        len = child_status_str(ci, buf + n, buflen - n);
+        if (n + len >= buflen - 4) {
+            n += snprintf(buf + n, buflen - n, "...\n");
+            break;
+        }
+        n += len;
+    }
+    pthread_mutex_unlock(&g_child_lock);
+    return n < buflen ? n : buflen - 1;
+}
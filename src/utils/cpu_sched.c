@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       Stackline cpu placement and per-core load in forker
+ *
+ * Stacklines are pinned with sched_setaffinity() (WF_CPUSET=) and placed in
+ * a cgroup v2 group per node range (WF_CGROUP=<name>:<cpu%>) under
+ * $WF_CGROUP_ROOT. The root has to be delegated to the user running
+ * whitefield with the cpu controller enabled in its parent. Failures are
+ * logged and the stackline runs unconstrained.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _CPU_SCHED_C_
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "commline/commline.h"
+#include "utils/forker_common.h"
+#include "utils/cpu_sched.h"
+
+#define CGROUP_ROOT_DEF "/sys/fs/cgroup/whitefield"
+
+static int write_file(const char *path, const char *val)
+{
+    FILE *fp = fopen(path, "w");
+    int   ret;
+
+    if (!fp) {
+        return FAILURE;
+    }
+    ret = fputs(val, fp) < 0 ? FAILURE : SUCCESS;
+    if (fclose(fp)) {
+        ret = FAILURE;
+    }
+    return ret;
+}
+
+/* Creates the group and sets its quota. Returns the group path in path. The
+ * quota is rewritten for every node of the range, which is idempotent. */
+int cg_prepare(const char *spec, char *path, int pathlen)
+{
+    char *      root = getenv("WF_CGROUP_ROOT");
+    char        name[64], file[512], val[64];
+    const char *ptr = strchr(spec, ':');
+    int         pct = 0;
+
+    if (!root || !*root) {
+        root = CGROUP_ROOT_DEF;
+    }
+    snprintf(name, sizeof(name), "%.*s", ptr ? (int)(ptr - spec) : (int)strlen(spec), spec);
+    if (!name[0] || strchr(name, '/')) {
+        ERROR("invalid cgroup spec [%s]\n", spec);
+        return FAILURE;
+    }
+    if (ptr) {
+        pct = atoi(ptr + 1);
+    }
+    if (mkdir(root, 0755) && errno != EEXIST) {
+        ERROR("cgroup root %s mkdir failed %m\n", root);
+        return FAILURE;
+    }
+    snprintf(file, sizeof(file), "%s/cgroup.subtree_control", root);
+    if (write_file(file, "+cpu")) {
+        WARN("could not enable cpu controller in %s %m\n", root);
+    }
+    snprintf(path, pathlen, "%s/%s", root, name);
+    if (mkdir(path, 0755) && errno != EEXIST) {
+        ERROR("cgroup %s mkdir failed %m\n", path);
+        return FAILURE;
+    }
+    if (pct > 0) {
+        snprintf(file, sizeof(file), "%s/cpu.max", path);
+        snprintf(val, sizeof(val), "%d 100000", pct * 1000);
+        if (write_file(file, val)) {
+            WARN("could not set %s=%s %m\n", file, val);
+        }
+    }
+    return SUCCESS;
+}
+
+/* Called in the forker with the pid of a child that waits for it before
+ * exec, so the stackline starts already placed. Done in the parent since
+ * stdio and logging are not safe in the child of a multi-threaded forker. */
+void cpu_place(pid_t pid, const char *cpuset, const char *cgpath)
+{
+    cpu_set_t set;
+    char      file[512], val[32];
+
+    if (cpuset) {
+        if (parse_cpulist(cpuset, &set) <= 0) {
+            ERROR("invalid cpuset [%s]\n", cpuset);
+        } else if (sched_setaffinity(pid, sizeof(set), &set)) {
+            ERROR("sched_setaffinity pid:%d [%s] failed %m\n", pid, cpuset);
+        }
+    }
+    if (cgpath) {
+        snprintf(file, sizeof(file), "%s/cgroup.procs", cgpath);
+        snprintf(val, sizeof(val), "%d", pid);
+        if (write_file(file, val)) {
+            ERROR("pid:%d could not join cgroup %s %m\n", pid, cgpath);
+        }
+    }
+}
+
+typedef struct _cpu_tick_ {
+    uint64_t busy, total;
+} cpu_tick_t;
+
+/* Per-core load since the previous call (since boot on the first call) */
+int cmd_cpu_load(cl_nodeid_t nodeid, char *buf, int buflen)
+{
+    static cpu_tick_t prev[CPU_SETSIZE];
+    char              line[256];
+    FILE *            fp;
+    int               n = 0, cpu;
+    uint64_t          v[8], busy, total;
+
+    fp = fopen("/proc/stat", "r");
+    if (!fp) {
+        return snprintf(buf, buflen, "could not open /proc/stat");
+    }
+    while (fgets(line, sizeof(line), fp) && n < buflen - 1) {
+        memset(v, 0, sizeof(v));
+        if (sscanf(line, "cpu%d %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64
+                   " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64, &cpu,
+                   &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) < 5 ||
+            cpu < 0 || cpu >= CPU_SETSIZE) {
+            continue;
+        }
+        total = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+        busy  = total - v[3] - v[4]; // idle and iowait
+        n += snprintf(buf + n, buflen - n, "cpu%d=%.1f%%\n", cpu,
+                      total > prev[cpu].total ?
+                      100.0 * (busy - prev[cpu].busy) / (total - prev[cpu].total) : 0.0);
+        prev[cpu].busy  = busy;
+        prev[cpu].total = total;
+    }
+    fclose(fp);
+    return n < buflen ? n : buflen - 1;
+}
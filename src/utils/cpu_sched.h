@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       CPU list parsing shared by the airline and the forker
+ *
+ * C users have to define _GNU_SOURCE before the first system header.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _CPU_SCHED_H_
+#define _CPU_SCHED_H_
+
+#include <sched.h>
+#include <stdlib.h>
+
+/* Parses a cpu list such as "0-3,6" into set. Returns the number of cpus in
+ * the set or -1 on a malformed list. */
+static inline int parse_cpulist(const char *list, cpu_set_t *set)
+{
+    char *end;
+    long  beg, last;
+
+    CPU_ZERO(set);
+    while (*list) {
+        beg = strtol(list, &end, 10);
+        if (end == list || beg < 0) {
+            return -1;
+        }
+        last = beg;
+        if (*end == '-') {
+            list = end + 1;
+            last = strtol(list, &end, 10);
+            if (end == list || last < beg) {
+                return -1;
+            }
+        }
+        if (last >= CPU_SETSIZE) {
+            return -1;
+        }
+        for (; beg <= last; beg++) {
+            CPU_SET(beg, set);
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end) {
+            return -1;
+        }
+        list = end;
+    }
+    return CPU_COUNT(set);
+}
+
+#endif // _CPU_SCHED_H_
@@ -28,18 +28,19 @@
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <elf.h>
 #include <pty.h>
 #include <sys/prctl.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include "commline/commline.h"
 #include "utils/forker_common.h"
 
-child_psinfo_t g_child_info[MAX_CHILD_PROCESS];
-
-void redirect_stdout_to_log(int nodeid)
+void redirect_stdout_to_log(int nodeid, int append)
 {
     int  fd;
     char logfile[512];
@@ -49,7 +50,7 @@ void redirect_stdout_to_log(int nodeid)
     } else {
         snprintf(logfile, sizeof(logfile), "%s/forker.log", getenv("LOGPATH") ? getenv("LOGPATH") : "log");
     }
-    fd = open(logfile, O_TRUNC | O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    fd = open(logfile, (append ? O_APPEND : O_TRUNC) | O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
     if (fd > 0) {
         dup2(fd, 1);
         dup2(fd, 2);
@@ -67,21 +68,114 @@ int chk_executable(char *bin)
     return SUCCESS;
 }
 
-#define SET_ARG_ENV(BUF)        \
-    if (strstr(BUF, "PTY=1")) { \
-        pty = 1;                \
-    } else {                    \
-        if (strchr(BUF, '=')) { \
-            envp[e++] = BUF;    \
-        } else {                \
-            argv[i++] = BUF;    \
-        }                       \
+/*
+ * The shim has to match the ELF class of the stackline, 32 bit binaries get
+ * libwf_ksm32.so when the toolchain could build it. Scripts and non ELF
+ * files get the native one. NULL if there is no shim for the class.
+ */
+static const char *ksm_shim_name(const char *bin)
+{
+    unsigned char ident[EI_NIDENT];
+    ssize_t       n  = -1;
+    int           fd = open(bin, O_RDONLY | O_CLOEXEC);
+
+    if (fd >= 0) {
+        n = read(fd, ident, sizeof(ident));
+        CLOSE(fd);
+    }
+    if (n != sizeof(ident) || memcmp(ident, ELFMAG, SELFMAG) ||
+        ident[EI_CLASS] == (sizeof(void *) == 8 ? ELFCLASS64 : ELFCLASS32)) {
+        return "/libwf_ksm.so";
     }
+    return ident[EI_CLASS] == ELFCLASS32 ? "/libwf_ksm32.so" : NULL;
+}
 
-int fork_n_exec(uint16_t nodeid, char *buf)
+/*
+ * Sets preload to LD_PRELOAD=<forker dir>/<shim for bin>, merged with and
+ * replacing any LD_PRELOAD already in envp.
+ */
+int ksm_preload_env(const char *bin, char **envp, int *e, char *preload, int len)
 {
-    char *argv[20] = { NULL }, *envp[20] = { NULL }, *ptr = NULL;
-    int   i = 0, e = 0, pty = 0;
+    char        shim[512], *dir;
+    const char *prev = NULL, *name = ksm_shim_name(bin);
+    ssize_t     n;
+    int         j;
+
+    if (!name) {
+        WARN("no KSM shim for the ELF class of %s, nodeKsm ignored\n", bin);
+        return FAILURE;
+    }
+    n = readlink("/proc/self/exe", shim, sizeof(shim) - strlen(name) - 1);
+    if (n <= 0) {
+        return FAILURE;
+    }
+    shim[n] = 0;
+    dir     = strrchr(shim, '/');
+    strcpy(dir ? dir : shim, name);
+    if (access(shim, R_OK)) {
+        WARN("%s not built, nodeKsm ignored for %s\n", shim, bin);
+        return FAILURE;
+    }
+    for (j = 0; j < *e; j++) {
+        if (!strncmp(envp[j], "LD_PRELOAD=", sizeof("LD_PRELOAD=") - 1)) {
+            prev    = envp[j] + sizeof("LD_PRELOAD=") - 1;
+            envp[j] = envp[--(*e)];
+            break;
+        }
+    }
+    snprintf(preload, len, "LD_PRELOAD=%s%s%s", shim, prev ? ":" : "", prev ? prev : "");
+    return SUCCESS;
+}
+
+// Tokens consumed by the forker, not passed in the stackline env
+#define FORKER_TOKEN(BUF, TOK, VAR)                 \
+    (!strncmp(BUF, TOK, sizeof(TOK) - 1) ? (VAR = BUF + sizeof(TOK) - 1) : NULL)
+
+#define SET_ARG_ENV(BUF)                                    \
+    if (strstr(BUF, "PTY=1")) {                             \
+        pty = 1;                                            \
+    } else if (FORKER_TOKEN(BUF, "WF_RESTART=", restart) || \
+               FORKER_TOKEN(BUF, "WF_CPUSET=", cpuset) ||   \
+               FORKER_TOKEN(BUF, "WF_CGROUP=", cgroup) ||   \
+               FORKER_TOKEN(BUF, "WF_KSM=", ksm) ||         \
+               FORKER_TOKEN(BUF, "WF_LOGRATE=", lograte)) { \
+    } else {                                                \
+        if (strchr(BUF, '=')) {                             \
+            envp[e++] = BUF;                                \
+        } else {                                            \
+            argv[i++] = BUF;                                \
+        }                                                   \
+    }
+
+int fork_n_exec(cl_nodeid_t nodeid, char *buf)
+{
+    char *          argv[20] = { NULL }, *envp[20] = { NULL }, *ptr = NULL;
+    char *          restart = NULL, *cpuset = NULL, *cgroup = NULL, *ksm = NULL, *lograte = NULL;
+    char            cgpath[512], preload[1024];
+    int             i = 0, e = 0, pty = 0, logfd[2] = { -1, -1 };
+    int             master = -1, append, placefd[2] = { -1, -1 };
+    pid_t           pid;
+    child_psinfo_t *ci;
+
+    ci = child_get(nodeid, 1);
+    if (!ci) {
+        ERROR("nodeid:%u could not get child process entry\n", nodeid);
+        return FAILURE;
+    }
+    child_lock();
+    if (ci->pid > 0 || ci->spawning) {
+        pid = ci->pid;
+        child_unlock();
+        ERROR("nodeid:%u is already running pid:%d\n", nodeid, pid);
+        return SUCCESS;
+    }
+    ci->spawning = 1;
+    if (ci->cmd != buf) {
+        free(ci->cmd);
+        ci->cmd = strdup(buf);
+    }
+    append = ci->exits > 0;
+    child_unlock();
 
     INFO("fork_n_exec: buf=[%s]\n", buf);
     while ((ptr = strchr(buf, '|'))) {
@@ -96,55 +190,104 @@ int fork_n_exec(uint16_t nodeid, char *buf)
 
     if (i < 1) {
         ERROR("Insufficient command exec info i=%d, e=%d\n", i, e);
-        return FAILURE;
+        goto fail;
     }
 
     if (chk_executable(argv[0]))
-        return -1;
+        goto fail;
+
+    if (ksm && atoi(ksm) &&
+        SUCCESS == ksm_preload_env(argv[0], envp, &e, preload, sizeof(preload))) {
+        envp[e++] = preload;
+        envp[e]   = NULL;
+    }
+
+    child_lock();
+    child_set_restart(ci, restart);
+    child_unlock();
+    if (cgroup && SUCCESS != cg_prepare(cgroup, cgpath, sizeof(cgpath))) {
+        cgroup = NULL;
+    }
+
+    if (log_aggr_enabled() && pipe2(logfd, O_CLOEXEC)) {
+        ERROR("log pipe failed %m, using node log file\n");
+    }
+    // the child waits on placefd till the parent has placed it
+    if ((cpuset || cgroup) && pipe2(placefd, O_CLOEXEC)) {
+        ERROR("placement pipe failed %m, not placing node:%u\n", nodeid);
+        cpuset = cgroup = NULL;
+    }
 
     if (pty) {
-        g_child_info[nodeid].pid = forkpty(&g_child_info[nodeid].master, NULL, NULL, NULL);
+        pid = forkpty(&master, NULL, NULL, NULL);
     } else {
-        g_child_info[nodeid].pid = fork();
+        pid = fork();
     }
-    if (g_child_info[nodeid].pid < 0) {
+    if (pid < 0) {
         ERROR("fork failed!!!pty:%d\n", pty);
-        return FAILURE;
+        CLOSE(logfd[0]);
+        CLOSE(logfd[1]);
+        CLOSE(placefd[0]);
+        CLOSE(placefd[1]);
+        goto fail;
     }
-    if (0 == g_child_info[nodeid].pid) {
+    if (0 == pid) {
         prctl(PR_SET_PDEATHSIG, SIGKILL); //If forker dies then it should send SIGKILL to all kids i.e. stackline processes
-        redirect_stdout_to_log(nodeid);
+        if (logfd[1] >= 0) {
+            dup2(logfd[1], 1);
+            dup2(logfd[1], 2);
+        } else {
+            redirect_stdout_to_log(nodeid, append);
+        }
+        if (pty) {
+            dup2(0, 1); // console output goes to the pty, stderr stays in the log
+        }
+        if (placefd[0] >= 0) {
+            char c;
+
+            close(placefd[1]);
+            while (read(placefd[0], &c, 1) < 0 && errno == EINTR)
+                ;
+        }
         execvpe(argv[0], argv, envp);
         ERROR("Could not execv [%s]. Check if the cmdname/path is correct.Aborting...\n", argv[0]);
         exit(0);
     }
-#if 0
-    if(pty) {
-        struct termios tios;
-
-        tcgetattr(g_child_info[nodeid].master, &tios);
-        tios.c_lflag &= ~(ECHO | ECHONL);
-        tcsetattr(g_child_info[nodeid].master, TCSAFLUSH, &tios);
-        g_child_info[nodeid].uds_fd = uds_open(nodeid);
-        if(g_child_info[nodeid].uds_fd < 0) {
-            ERROR("Failed to open unix domain sock\n");
-            //Dont bother to cleanup since everything will stop after this failure
-            return FAILURE;
-        }
-        pty_add_fd(nodeid, g_child_info[nodeid].uds_fd, 0);
-        pty_add_fd(nodeid, g_child_info[nodeid].master, 1);
+    if (placefd[0] >= 0) {
+        CLOSE(placefd[0]);
+        cpu_place(pid, cpuset, cgroup ? cgpath : NULL);
+        CLOSE(placefd[1]); // releases the child to exec
+    }
+    child_lock();
+    ci->pid      = pid;
+    ci->master   = master;
+    ci->spawning = 0;
+    child_unlock();
+    child_add(ci);
+    if (logfd[1] >= 0) {
+        CLOSE(logfd[1]);
+        log_aggr_add(ci, logfd[0], lograte);
+    }
+    if (pty && SUCCESS != pty_add_node(ci)) {
+        ERROR("nodeid:%u pty console setup failed\n", nodeid);
     }
-#endif
     return SUCCESS;
+fail:
+    child_lock();
+    ci->spawning = 0;
+    child_unlock();
+    return FAILURE;
 }
 
-void killall_childprocess(void)
+/* Every PTY node holds a pty master and a listening socket (plus a client
+ * connection) in the forker, and every node with log aggregation a pipe. */
+static void raise_nofile_limit(void)
 {
-    int i;
-    for (i = 0; i < MAX_CHILD_PROCESS; i++) {
-        if (g_child_info[i].pid <= 0)
-            continue;
-        kill(g_child_info[i].pid, SIGINT);
+    struct rlimit rl;
+
+    if (!getrlimit(RLIMIT_NOFILE, &rl) && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
     }
 }
 
@@ -162,13 +305,17 @@ void wait_on_q(void)
                 break;
         }
     }
-    killall_childprocess();
+    child_killall(SIGINT);
+    if (log_aggr_enabled()) {
+        usleep(200000); // let the aggregator drain the last lines
+        log_aggr_flush();
+    }
     INFO("Quitting forker process\n");
 }
 
 int main(void)
 {
-    redirect_stdout_to_log(-1);
+    redirect_stdout_to_log(-1, 0);
     INFO("Starting forker...\n");
     if (SUCCESS != cl_init(MTYPE(FORKER, CL_MGR_ID), CL_ATTACHQ)) {
         ERROR("forker: failure to cl_init()\n");
@@ -178,8 +325,17 @@ int main(void)
         ERROR("forker: failure to cl_bind()\n");
         return 1;
     }
+    if (SUCCESS != start_log_aggr_thread()) {
+        ERROR("start_log_aggr_thread failed... exiting process!!\n");
+        return 1;
+    }
+    if (SUCCESS != start_reaper_thread()) {
+        ERROR("start_reaper_thread failed... exiting process!!\n");
+        return 1;
+    }
+    raise_nofile_limit();
     if (SUCCESS != start_pty_thread()) {
-        ERROR("start_monitor_thread failed... exiting process!!\n");
+        ERROR("start_pty_thread failed... exiting process!!\n");
         return 1;
     }
     if (SUCCESS != start_monitor_thread()) {
@@ -1,21 +1,74 @@
 #ifndef _FORKER_COMMON_H_
 #define _FORKER_COMMON_H_
 
+#include <time.h>
 #include <sys/un.h>
 
-#define MAX_CHILD_PROCESS 2000
+enum {
+    RESTART_NEVER,
+    RESTART_ON_FAILURE, // non-zero exit status or killed by a signal
+    RESTART_ALWAYS,
+};
+
 typedef struct _child_info_ {
+    cl_nodeid_t        nodeid;
     pid_t              pid;
-    int                master;
-    int                uds_fd;
-    struct sockaddr_un peer;
-    socklen_t          peerlen;
+    uint8_t            spawning; // fork_n_exec in progress
+    int                pidfd;
+    int                exit_status; // as returned by waitpid()
+    uint32_t           exits;
+    uint32_t           restarts;
+    time_t             start_time;
+    time_t             exit_time;
+    char *             cmd; // original fork_n_exec buf, used for respawn
+    uint8_t            restart_policy;
+    uint32_t           restart_max; // 0 = no limit
+    uint32_t           restart_backoff_ms;
+    uint32_t           auto_restarts;
+    uint64_t           respawn_at_ms; // 0 = no respawn pending
+    uint32_t           log_rate;      // bytes/sec, 0 = no limit
+    uint32_t           log_dropped;
+    double             log_tokens;
+    uint64_t           log_last_us;
+    int                master;   // pty master until handed over to pty_add_node()
+    struct _pty_sess_ *pty_sess; // console session of the current PTY=1 instance
+    struct _pty_ring_ *pty_ring; // console scrollback, kept across restarts
 } child_psinfo_t;
 
+// forker.c exported functions
+int fork_n_exec(cl_nodeid_t nodeid, char *buf);
+
+// child_table.c exported functions
+child_psinfo_t *child_get(cl_nodeid_t nodeid, int create);
+uint32_t        child_count(void); // highest spawned node id + 1
+int             child_set_restart(child_psinfo_t *ci, const char *policy);
+int             child_add(child_psinfo_t *ci);
+pid_t           child_pid(child_psinfo_t *ci); // 0 if not running
+void            child_lock(void); // guards the child_psinfo_t fields
+void            child_unlock(void);
+void            child_killall(int signum);
+int             start_reaper_thread(void);
+int             cmd_node_status(cl_nodeid_t nodeid, char *buf, int buflen);
+
+// cpu_sched.c exported functions
+int  cg_prepare(const char *spec, char *path, int pathlen);
+void cpu_place(pid_t pid, const char *cpuset, const char *cgpath);
+int  cmd_cpu_load(cl_nodeid_t nodeid, char *buf, int buflen);
+
+// mem_stats.c exported functions
+int cmd_ksm_stats(cl_nodeid_t nodeid, char *buf, int buflen);
+int cmd_node_mem(cl_nodeid_t nodeid, char *buf, int buflen);
+
+// log_aggr.c exported functions
+int  start_log_aggr_thread(void);
+int  log_aggr_enabled(void);
+int  log_aggr_add(child_psinfo_t *ci, int fd, const char *rate);
+void log_aggr_flush(void);
+
 // pty_handler.c exported functions
 int start_pty_thread(void);
-int pty_add_fd(int nodeid, int fd, int ismaster);
-int uds_open(int nodeid);
+int pty_add_node(child_psinfo_t *ci);
+int uds_get_path(int nodeid, char *path, int maxlen);
 
 // monitor.c exported functions
 int start_monitor_thread(void);
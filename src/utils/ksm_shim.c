@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       LD_PRELOAD shim that opts a stackline into KSM merging
+ *
+ * Preloaded by the forker for nodes with nodeKsm=1. On Linux >= 6.4 the
+ * whole process is made mergeable with PR_SET_MEMORY_MERGE, covering heap
+ * allocated later. On older kernels the writable private mappings present at
+ * startup are marked MADV_MERGEABLE. KSM itself has to be enabled with
+ * /sys/kernel/mm/ksm/run=1.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+
+#ifndef PR_SET_MEMORY_MERGE
+#define PR_SET_MEMORY_MERGE 67
+#endif
+
+static void madvise_writable_maps(void)
+{
+    char          line[512], perm[8];
+    unsigned long beg, end;
+    FILE *        fp = fopen("/proc/self/maps", "r");
+
+    if (!fp) {
+        return;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "%lx-%lx %4s", &beg, &end, perm) != 3) {
+            continue;
+        }
+        // private writable only, [stack]/[vvar] etc fail harmlessly
+        if (perm[1] != 'w' || perm[3] != 'p') {
+            continue;
+        }
+        madvise((void *)beg, end - beg, MADV_MERGEABLE);
+    }
+    fclose(fp);
+}
+
+__attribute__((constructor)) static void wf_ksm_init(void)
+{
+    if (!prctl(PR_SET_MEMORY_MERGE, 1, 0, 0, 0)) {
+        return;
+    }
+    madvise_writable_maps();
+}
@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       Node log aggregator thread in forker
+ *
+ * With WF_LOG_AGGR=1 every stackline's stdout/stderr is a pipe read by this
+ * thread. Lines are tagged with the node id and time and written as
+ * compressed chunks to $LOGPATH/nodes.wflog (see wflog.h). The file is
+ * rotated at WF_LOG_ROTATE_MB keeping WF_LOG_KEEP old files. Each node is
+ * rate limited to its WF_LOGRATE= (default WF_LOG_RATE) bytes/sec, excess
+ * lines are dropped and the drop count is logged once the node is back
+ * under its limit.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _LOG_AGGR_C_
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <zlib.h>
+#include "commline/commline.h"
+#include "utils/forker_common.h"
+#include "utils/wflog.h"
+
+#define FLUSH_INTERVAL_US 1000000
+
+typedef struct _log_src_ {
+    child_psinfo_t *ci;
+    int             fd;
+    uint16_t        partlen;
+    char            part[WFLOG_LINE_MAX];
+} log_src_t;
+
+static int             g_log_aggr;
+static int             g_log_epollfd = -1;
+static int             g_log_fd      = -1;
+static char            g_log_path[512];
+static uint64_t        g_log_size, g_rotate_bytes;
+static int             g_rotate_keep;
+static uint32_t        g_def_rate;
+static pthread_mutex_t g_chunk_lock = PTHREAD_MUTEX_INITIALIZER;
+static wflog_chunk_t   g_chunk;
+static uint8_t         g_ubuf[WFLOG_CHUNK_SZ];
+static uint8_t *       g_cbuf;
+static uLong           g_cbuf_sz;
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int log_aggr_enabled(void)
+{
+    return g_log_aggr;
+}
+
+static int log_open(void)
+{
+    g_log_fd = open(g_log_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (g_log_fd < 0) {
+        ERROR("could not open %s %m\n", g_log_path);
+        return FAILURE;
+    }
+    g_log_size = 0;
+    return SUCCESS;
+}
+
+/* nodes.wflog -> nodes.wflog.1 -> ... -> nodes.wflog.<keep> */
+static void log_rotate(void)
+{
+    char src[600], dst[600];
+    int  i;
+
+    CLOSE(g_log_fd);
+    for (i = g_rotate_keep; i > 0; i--) {
+        snprintf(dst, sizeof(dst), "%s.%d", g_log_path, i);
+        if (i > 1) {
+            snprintf(src, sizeof(src), "%s.%d", g_log_path, i - 1);
+        } else {
+            snprintf(src, sizeof(src), "%s", g_log_path);
+        }
+        rename(src, dst);
+    }
+    if (!g_rotate_keep) {
+        unlink(g_log_path);
+    }
+    log_open();
+}
+
+/* Caller holds g_chunk_lock */
+static void chunk_flush(void)
+{
+    uLong clen = g_cbuf_sz;
+
+    if (!g_chunk.nrec) {
+        return;
+    }
+    if (compress2(g_cbuf, &clen, g_ubuf, g_chunk.ulen, 3) != Z_OK) {
+        ERROR("log chunk compress failed, %u records lost\n", g_chunk.nrec);
+        goto reset;
+    }
+    g_chunk.magic = WFLOG_MAGIC;
+    g_chunk.clen  = clen;
+    if (g_log_fd >= 0 &&
+        (write(g_log_fd, &g_chunk, sizeof(g_chunk)) != sizeof(g_chunk) ||
+         write(g_log_fd, g_cbuf, clen) != (ssize_t)clen)) {
+        ERROR("log chunk write failed %m\n");
+    }
+    g_log_size += sizeof(g_chunk) + clen;
+    if (g_rotate_bytes && g_log_size >= g_rotate_bytes) {
+        log_rotate();
+    }
+reset:
+    memset(&g_chunk, 0, sizeof(g_chunk));
+}
+
+void log_aggr_flush(void)
+{
+    pthread_mutex_lock(&g_chunk_lock);
+    chunk_flush();
+    pthread_mutex_unlock(&g_chunk_lock);
+}
+
+static void log_record(cl_nodeid_t nodeid, const char *line, uint16_t len)
+{
+    wflog_rec_t rec;
+
+    rec.t_us   = now_us();
+    rec.nodeid = nodeid;
+    rec.len    = len;
+    pthread_mutex_lock(&g_chunk_lock);
+    if (g_chunk.ulen + sizeof(rec) + len > sizeof(g_ubuf)) {
+        chunk_flush();
+    }
+    if (!g_chunk.nrec) {
+        g_chunk.t_first_us = rec.t_us;
+        g_chunk.node_min   = nodeid;
+        g_chunk.node_max   = nodeid;
+    }
+    g_chunk.t_last_us = rec.t_us;
+    if (nodeid < g_chunk.node_min) {
+        g_chunk.node_min = nodeid;
+    }
+    if (nodeid > g_chunk.node_max) {
+        g_chunk.node_max = nodeid;
+    }
+    memcpy(g_ubuf + g_chunk.ulen, &rec, sizeof(rec));
+    memcpy(g_ubuf + g_chunk.ulen + sizeof(rec), line, len);
+    g_chunk.ulen += sizeof(rec) + len;
+    g_chunk.nrec++;
+    pthread_mutex_unlock(&g_chunk_lock);
+}
+
+static void log_drop_note(child_psinfo_t *ci)
+{
+    char note[64];
+    int  n;
+
+    if (ci->log_dropped) {
+        n = snprintf(note, sizeof(note), "[wf: rate limited, dropped %u bytes]", ci->log_dropped);
+        log_record(ci->nodeid, note, n);
+        ci->log_dropped = 0;
+    }
+}
+
+/* Token bucket with a burst of one second worth of bytes */
+static int log_rate_ok(child_psinfo_t *ci, uint16_t len)
+{
+    uint64_t now;
+
+    if (!ci->log_rate) {
+        return 1;
+    }
+    now = now_us();
+    ci->log_tokens += (double)(now - ci->log_last_us) * ci->log_rate / 1000000;
+    if (ci->log_tokens > ci->log_rate) {
+        ci->log_tokens = ci->log_rate;
+    }
+    ci->log_last_us = now;
+    if (ci->log_tokens < len) {
+        ci->log_dropped += len;
+        return 0;
+    }
+    ci->log_tokens -= len;
+    log_drop_note(ci);
+    return 1;
+}
+
+/* The ci->log_* fields are also set by the forker thread on (re)spawn */
+static void log_line(log_src_t *src, const char *line, uint16_t len)
+{
+    int ok;
+
+    child_lock();
+    ok = log_rate_ok(src->ci, len);
+    child_unlock();
+    if (ok) {
+        log_record(src->ci->nodeid, line, len);
+    }
+}
+
+static void log_src_read(log_src_t *src)
+{
+    char    buf[4096], *ptr, *nl;
+    ssize_t n = read(src->fd, buf, sizeof(buf));
+
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return; // epoll reports it again if there is data
+    }
+    if (n <= 0) {
+        if (src->partlen) {
+            log_line(src, src->part, src->partlen);
+        }
+        child_lock();
+        log_drop_note(src->ci);
+        child_unlock();
+        epoll_ctl(g_log_epollfd, EPOLL_CTL_DEL, src->fd, NULL);
+        CLOSE(src->fd);
+        free(src);
+        return;
+    }
+    for (ptr = buf; n > 0;) {
+        nl          = memchr(ptr, '\n', n);
+        size_t take = nl ? (size_t)(nl - ptr) : (size_t)n;
+
+        if (take > sizeof(src->part) - src->partlen) {
+            take = sizeof(src->part) - src->partlen;
+            nl   = NULL;
+        }
+        memcpy(src->part + src->partlen, ptr, take);
+        src->partlen += take;
+        ptr += take;
+        n -= take;
+        if (nl) { // skip the newline
+            ptr++;
+            n--;
+        }
+        if (nl || src->partlen == sizeof(src->part)) {
+            log_line(src, src->part, src->partlen);
+            src->partlen = 0;
+        }
+    }
+}
+
+#define MAXEVENTS 64
+static void *log_aggr_thread(void *arg)
+{
+    struct epoll_event events[MAXEVENTS];
+    int                n, i;
+
+    for (;;) {
+        n = epoll_wait(g_log_epollfd, events, MAXEVENTS, FLUSH_INTERVAL_US / 1000);
+        for (i = 0; i < n; i++) {
+            log_src_read(events[i].data.ptr);
+        }
+        pthread_mutex_lock(&g_chunk_lock);
+        if (g_chunk.nrec && now_us() - g_chunk.t_first_us >= FLUSH_INTERVAL_US) {
+            chunk_flush();
+        }
+        pthread_mutex_unlock(&g_chunk_lock);
+    }
+    return NULL;
+}
+
+/* Takes over the read end of the node's stdout pipe */
+int log_aggr_add(child_psinfo_t *ci, int fd, const char *rate)
+{
+    struct epoll_event ev;
+    log_src_t *        src = calloc(1, sizeof(*src));
+
+    child_lock();
+    ci->log_rate = rate ? strtoul(rate, NULL, 10) : g_def_rate;
+    if (!ci->log_last_us) {
+        ci->log_tokens  = ci->log_rate;
+        ci->log_last_us = now_us();
+    }
+    child_unlock();
+    if (!src) {
+        close(fd);
+        return FAILURE;
+    }
+    src->ci    = ci;
+    src->fd    = fd;
+    ev.events   = EPOLLIN;
+    ev.data.ptr = src;
+    if (epoll_ctl(g_log_epollfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        ERROR("epoll_ctl failed nodeid:%u fd:%d %m\n", ci->nodeid, fd);
+        close(fd);
+        free(src);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+int start_log_aggr_thread(void)
+{
+    pthread_t tid;
+    char *    ptr;
+
+    ptr = getenv("WF_LOG_AGGR");
+    if (!ptr || !atoi(ptr)) {
+        return SUCCESS;
+    }
+    ptr            = getenv("WF_LOG_ROTATE_MB");
+    g_rotate_bytes = (uint64_t)(ptr ? atoi(ptr) : 64) * 1024 * 1024;
+    ptr            = getenv("WF_LOG_KEEP");
+    g_rotate_keep  = ptr ? atoi(ptr) : 4;
+    ptr            = getenv("WF_LOG_RATE");
+    g_def_rate     = ptr ? strtoul(ptr, NULL, 10) : 0;
+    snprintf(g_log_path, sizeof(g_log_path), "%s/" WFLOG_FILE,
+             getenv("LOGPATH") ? getenv("LOGPATH") : "log");
+
+    g_cbuf_sz = compressBound(sizeof(g_ubuf));
+    g_cbuf    = malloc(g_cbuf_sz);
+    if (!g_cbuf || SUCCESS != log_open()) {
+        return FAILURE;
+    }
+    g_log_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_log_epollfd < 0) {
+        ERROR("failed creating epollfd %m\n");
+        return FAILURE;
+    }
+    if (pthread_create(&tid, NULL, log_aggr_thread, NULL)) {
+        ERROR("failure creating log aggregator thread %m\n");
+        CLOSE(g_log_epollfd);
+        return FAILURE;
+    }
+    pthread_detach(tid);
+    g_log_aggr = 1;
+    INFO("node logs aggregated in %s\n", g_log_path);
+    return SUCCESS;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       Stackline memory usage and KSM sharing stats in forker
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _MEM_STATS_C_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "commline/commline.h"
+#include "utils/forker_common.h"
+
+#define KSM_SYSFS "/sys/kernel/mm/ksm/"
+
+static long read_long(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    long  val = -1;
+
+    if (fp) {
+        if (fscanf(fp, "%ld", &val) != 1) {
+            val = -1;
+        }
+        fclose(fp);
+    }
+    return val;
+}
+
+typedef struct _proc_mem_ {
+    uint64_t rss_kb, pss_kb, ksm_kb;
+} proc_mem_t;
+
+static int get_proc_mem(pid_t pid, proc_mem_t *pm)
+{
+    char     path[64], line[128];
+    FILE *   fp;
+    uint64_t val;
+    long     ksm_pages;
+
+    memset(pm, 0, sizeof(*pm));
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+    fp = fopen(path, "r");
+    if (!fp) {
+        return FAILURE;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "Rss: %" SCNu64, &val) == 1) {
+            pm->rss_kb = val;
+        } else if (sscanf(line, "Pss: %" SCNu64, &val) == 1) {
+            pm->pss_kb = val;
+        }
+    }
+    fclose(fp);
+    snprintf(path, sizeof(path), "/proc/%d/ksm_merging_pages", pid);
+    ksm_pages = read_long(path);
+    if (ksm_pages > 0) {
+        pm->ksm_kb = (uint64_t)ksm_pages * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+    return SUCCESS;
+}
+
+/* System wide KSM state. ratio is the number of mappings per shared page. */
+int cmd_ksm_stats(cl_nodeid_t nodeid, char *buf, int buflen)
+{
+    long run      = read_long(KSM_SYSFS "run");
+    long shared   = read_long(KSM_SYSFS "pages_shared");
+    long sharing  = read_long(KSM_SYSFS "pages_sharing");
+    long unshared = read_long(KSM_SYSFS "pages_unshared");
+    long profit   = read_long(KSM_SYSFS "general_profit");
+
+    if (run < 0) {
+        return snprintf(buf, buflen, "KSM_NOT_SUPPORTED");
+    }
+    return snprintf(buf, buflen,
+                    "run=%ld pages_shared=%ld pages_sharing=%ld pages_unshared=%ld "
+                    "ratio=%.2f saved_kb=%ld profit_kb=%ld%s",
+                    run, shared, sharing, unshared,
+                    shared > 0 ? (double)sharing / shared : 0.0,
+                    sharing > 0 ? sharing * (sysconf(_SC_PAGESIZE) / 1024) : 0,
+                    profit > 0 ? profit / 1024 : 0,
+                    run == 1 ? "" : "\nKSM is not running, echo 1 > " KSM_SYSFS "run");
+}
+
+/* Without a node id, the fleet totals are followed by one line per running
+ * node, truncated with "..." if it does not fit. */
+int cmd_node_mem(cl_nodeid_t nodeid, char *buf, int buflen)
+{
+    child_psinfo_t *ci;
+    pid_t           pid;
+    proc_mem_t      pm, tot;
+    uint32_t        i, cnt = child_count(), nodes = 0;
+    int             n = 0, len;
+    char            line[128];
+
+    if (nodeid != CL_MGR_ID) {
+        ci = child_get(nodeid, 0);
+        if (!ci || (pid = child_pid(ci)) <= 0 || get_proc_mem(pid, &pm)) {
+            return snprintf(buf, buflen, "NODE_NOT_RUNNING");
+        }
+        return snprintf(buf, buflen, "%u: rss_kb=%" PRIu64 " pss_kb=%" PRIu64 " ksm_kb=%" PRIu64,
+                        nodeid, pm.rss_kb, pm.pss_kb, pm.ksm_kb);
+    }
+    memset(&tot, 0, sizeof(tot));
+    for (i = 0; i < cnt; i++) {
+        ci = child_get(i, 0);
+        if (!ci || (pid = child_pid(ci)) <= 0 || get_proc_mem(pid, &pm)) {
+            continue;
+        }
+        nodes++;
+        tot.rss_kb += pm.rss_kb;
+        tot.pss_kb += pm.pss_kb;
+        tot.ksm_kb += pm.ksm_kb;
+    }
+    n = snprintf(buf, buflen, "nodes=%u rss_kb=%" PRIu64 " pss_kb=%" PRIu64 " ksm_kb=%" PRIu64
+                 " pss_per_node_kb=%" PRIu64 "\n",
+                 nodes, tot.rss_kb, tot.pss_kb, tot.ksm_kb, nodes ? tot.pss_kb / nodes : 0);
+    for (i = 0; i < cnt && n < buflen; i++) {
+        ci = child_get(i, 0);
+        if (!ci || (pid = child_pid(ci)) <= 0 || get_proc_mem(pid, &pm)) {
+            continue;
+        }
+        len = snprintf(line, sizeof(line), "%u: rss_kb=%" PRIu64 " pss_kb=%" PRIu64 " ksm_kb=%" PRIu64 "\n",
+                       i, pm.rss_kb, pm.pss_kb, pm.ksm_kb);
+        if (n + len >= buflen - 4) {
+            n += snprintf(buf + n, buflen - n, "...\n");
+            break;
+        }
+        memcpy(buf + n, line, len + 1);
+        n += len;
+    }
+    return n < buflen ? n : buflen - 1;
+}
@@ -30,6 +30,7 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include "commline/commline.h"
+#include "utils/forker_common.h"
 
 int gMonitorFD = -1;
 int start_udp_server(int portno)
@@ -59,23 +60,59 @@ failure:
     return FAILURE;
 }
 
+/* Commands served by the forker itself. "FK:[<nodeid>:]<cmd>" */
+int handle_forker_cmd(char *cmd, char *rsp, size_t rsplen)
+{
+    cl_nodeid_t id = CL_MGR_ID;
+    char *      ptr;
+
+    cmd += sizeof("FK:") - 1;
+    if (isdigit(*cmd)) {
+        id  = strtoul(cmd, NULL, 10);
+        ptr = strchr(cmd, ':');
+        if (!ptr) {
+            return snprintf(rsp, rsplen, "INVALID_CMD");
+        }
+        cmd = ptr + 1;
+    }
+    if (!strcmp(cmd, "cmd_node_status")) {
+        return cmd_node_status(id, rsp, rsplen);
+    }
+    if (!strcmp(cmd, "cmd_cpu_load")) {
+        return cmd_cpu_load(id, rsp, rsplen);
+    }
+    if (!strcmp(cmd, "cmd_ksm_stats")) {
+        return cmd_ksm_stats(id, rsp, rsplen);
+    }
+    if (!strcmp(cmd, "cmd_node_mem")) {
+        return cmd_node_mem(id, rsp, rsplen);
+    }
+    return snprintf(rsp, rsplen, "INVALID_CMD");
+}
+
 int fwd_cmd_on_commline(char *cmd, size_t cmdlen, char *rsp, size_t rsplen)
 {
     DEFINE_MBUF_SZ(mbuf, MAX_CMD_RSP_SZ);
-    int   line = 0, c = 0, id = CL_MGR_ID;
+    int         line = 0, c = 0;
+    cl_nodeid_t id   = CL_MGR_ID;
     char *ptr;
 
     if (!strncasecmp(cmd, "AL:", sizeof("AL:") - 1)) {
         line = AIRLINE;
     } else if (!strncasecmp(cmd, "SL:", sizeof("SL:") - 1)) {
         line = STACKLINE;
+    } else if (!strncasecmp(cmd, "FK:", sizeof("FK:") - 1)) {
+        return handle_forker_cmd(cmd, rsp, rsplen);
     } else {
         return snprintf(rsp, rsplen, "INVALID_LINE");
     }
     ptr    = strchr(cmd, ':');
     *ptr++ = 2;
     if (isdigit(*ptr)) {
-        mbuf->src_id = atoi(ptr);
+        mbuf->src_id = strtoul(ptr, NULL, 10);
+        if (mbuf->src_id == 0xffff) {
+            mbuf->src_id = CL_MGR_ID; // legacy notation for all nodes
+        }
         cmd          = strchr(ptr, ':');
         if (!cmd) {
             return snprintf(rsp, rsplen, "INVALID_CMD");
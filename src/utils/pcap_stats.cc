@@ -0,0 +1,603 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     utils
+ * @{
+ *
+ * @file
+ * @brief       Native RPL control traffic stats from pcap
+ *
+ * Single pass replacement for the tshark/capinfos based
+ * scripts/rpl_pcap_stats.sh. Decodes 802.15.4 + 6LoWPAN (IPHC/NHC) +
+ * ICMPv6 directly from an mmap'ed pcap and emits the same JSON.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _PCAP_STATS_CC_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#define SUCCESS 0
+#define FAILURE -1
+
+#define PCAP_MAGIC_US    0xa1b2c3d4
+#define PCAP_MAGIC_NS    0xa1b23c4d
+#define PCAP_GHDR_LEN    24
+#define PCAP_RHDR_LEN    16
+#define DLT_WPAN_WITHFCS 195
+#define DLT_WPAN_NOFCS   230
+#define DLT_WPAN_NONASK  215
+
+#define ICMPV6_NH     58
+#define ICMP_RPL_TYPE 155
+#define WPAN_BCAST16  0xffff
+
+/* Number of consecutive valid record headers needed to trust a resync */
+#define RESYNC_CHAIN 8
+
+enum {
+    RPL_DIS,
+    RPL_DIO,
+    RPL_DAO,
+    RPL_DAOACK,
+    RPL_MAX_CODE
+};
+
+enum {
+    DST_MCAST,
+    DST_UCAST,
+    DST_MAX
+};
+
+typedef struct _cnt_ {
+    uint64_t pkts;
+    uint64_t bytes;
+} cnt_t;
+
+typedef struct _stats_ {
+    cnt_t    rpl[RPL_MAX_CODE][DST_MAX];
+    uint64_t tot_pkts;
+    double   first_ts, last_ts;
+} stats_t;
+
+typedef struct _pcap_ {
+    const uint8_t *base;
+    size_t         len;
+    int            swap;
+    int            nsec;
+    int            fcs;
+    uint32_t       snaplen;
+    uint32_t       first_sec;
+} pcap_t;
+
+static inline uint32_t rd32(const pcap_t *pc, const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return pc->swap ? __builtin_bswap32(v) : v;
+}
+
+static inline uint16_t le16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+/* Skips IPv6 extension headers (uncompressed form). Returns final NH */
+static int ipv6_skip_ext(int nh, const uint8_t **pp, const uint8_t *end)
+{
+    const uint8_t *p = *pp;
+
+    while (nh == 0 || nh == 43 || nh == 60 || nh == 44) {
+        int hlen = (nh == 44) ? 8 : (p + 2 <= end ? (p[1] + 1) * 8 : 0);
+        if (!hlen || p + hlen > end) {
+            return -1;
+        }
+        nh = p[0];
+        p += hlen;
+    }
+    *pp = p;
+    return nh;
+}
+
+static const int iphc_sam_len[2][4] = { { 16, 8, 2, 0 }, { 0, 8, 2, 0 } };
+static const int iphc_mdam_len[2][4] = { { 16, 6, 4, 1 }, { 6, -1, -1, -1 } };
+static const int iphc_tf_len[4]      = { 4, 3, 1, 0 };
+
+/*
+ * Decodes an IPHC header followed by any NHC extension headers.
+ * Returns the final next header value and updates *pp to point to its
+ * payload. Returns -1 if the upper layer header is not reachable (NHC UDP,
+ * non-first fragment, unsupported encoding etc).
+ */
+static int lowpan_iphc(const uint8_t **pp, const uint8_t *end, int depth)
+{
+    const uint8_t *p = *pp;
+    int            nh = -1, nhc, len;
+    uint8_t        b0, b1;
+
+    if (p + 2 > end || depth > 2) {
+        return -1;
+    }
+    b0 = p[0];
+    b1 = p[1];
+    p += 2;
+    if (b1 & 0x80) { /* CID */
+        p++;
+    }
+    p += iphc_tf_len[(b0 >> 3) & 3];
+    nhc = b0 & 0x04;
+    if (!nhc) {
+        if (p >= end) {
+            return -1;
+        }
+        nh = *p++;
+    }
+    if (!(b0 & 3)) { /* HLIM inline */
+        p++;
+    }
+    p += iphc_sam_len[(b1 >> 6) & 1][(b1 >> 4) & 3];
+    if (b1 & 0x08) {
+        len = iphc_mdam_len[(b1 >> 2) & 1][b1 & 3];
+    } else {
+        len = iphc_sam_len[(b1 >> 2) & 1][b1 & 3];
+    }
+    if (len < 0) {
+        return -1;
+    }
+    p += len;
+    if (p > end) {
+        return -1;
+    }
+    if (!nhc) {
+        *pp = p;
+        return ipv6_skip_ext(nh, pp, end);
+    }
+
+    /* LOWPAN_NHC chain */
+    while (p < end) {
+        uint8_t d = *p;
+
+        if ((d & 0xf0) != 0xe0) {
+            return -1; /* UDP NHC (11110xxx) or unknown */
+        }
+        int eid = (d >> 1) & 7;
+        p++;
+        if (eid == 7) { /* Encapsulated IPv6, IPHC follows */
+            *pp = p;
+            return lowpan_iphc(pp, end, depth + 1);
+        }
+        if (!(d & 1)) { /* NH inline */
+            if (p >= end) {
+                return -1;
+            }
+            nh = *p++;
+        } else {
+            nh = -1;
+        }
+        if (eid == 2) { /* Fragment header, carried inline */
+            p += 7;
+        } else {
+            if (p >= end) {
+                return -1;
+            }
+            p += 1 + *p;
+        }
+        if (p > end) {
+            return -1;
+        }
+        if (nh >= 0) {
+            *pp = p;
+            return ipv6_skip_ext(nh, pp, end);
+        }
+    }
+    return -1;
+}
+
+/* Returns upper layer next header and pointer to its payload */
+static int lowpan_decode(const uint8_t **pp, const uint8_t *end)
+{
+    const uint8_t *p = *pp;
+
+    while (p < end) {
+        uint8_t d = *p;
+
+        if (d == 0x41) { /* Uncompressed IPv6 */
+            if (p + 41 > end) {
+                return -1;
+            }
+            *pp = p + 41;
+            return ipv6_skip_ext(p[7], pp, end);
+        } else if ((d & 0xe0) == 0x60) { /* IPHC */
+            *pp = p;
+            return lowpan_iphc(pp, end, 0);
+        } else if ((d & 0xc0) == 0x80) { /* Mesh header */
+            int hops = d & 0x0f;
+            p += 1 + ((d & 0x20) ? 2 : 8) + ((d & 0x10) ? 2 : 8);
+            if (hops == 0x0f) {
+                p++;
+            }
+        } else if (d == 0x50) { /* LOWPAN_BC0 */
+            p += 2;
+        } else if ((d & 0xf8) == 0xc0) { /* FRAG1 */
+            p += 4;
+        } else {
+            return -1; /* FRAGN, NALP, 6LoRH etc */
+        }
+    }
+    return -1;
+}
+
+/*
+ * Decodes the 802.15.4 MAC header. Returns the 16-bit dst address, 0x10000
+ * if the dst is not a short address, or -1 if the frame is not a readable
+ * data frame.
+ */
+static int wpan_decode(const uint8_t **pp, const uint8_t *end)
+{
+    const uint8_t *p = *pp;
+    uint16_t       fc;
+    int            dmode, smode, ver, dst = 0x10000;
+
+    if (p + 3 > end) {
+        return -1;
+    }
+    fc    = le16(p);
+    dmode = (fc >> 10) & 3;
+    ver   = (fc >> 12) & 3;
+    smode = (fc >> 14) & 3;
+    if ((fc & 7) != 1 || (fc & 0x08)) { /* Not data or secured */
+        return -1;
+    }
+    p += 2;
+    if (!(ver == 2 && (fc & 0x100))) { /* seq num not suppressed */
+        p++;
+    }
+    if (dmode) {
+        p += 2;
+        if (dmode == 2) {
+            if (p + 2 > end) {
+                return -1;
+            }
+            dst = le16(p);
+        }
+        p += (dmode == 2) ? 2 : 8;
+    }
+    if (smode) {
+        if (!(fc & 0x40)) {
+            p += 2;
+        }
+        p += (smode == 2) ? 2 : 8;
+    }
+    if (p > end) {
+        return -1;
+    }
+    *pp = p;
+    return dst;
+}
+
+static void handle_pkt(stats_t *st, const pcap_t *pc, const uint8_t *pkt,
+                       uint32_t caplen, uint32_t origlen, double ts)
+{
+    const uint8_t *p = pkt, *end = pkt + caplen;
+    int            dst, nh, code;
+
+    st->tot_pkts++;
+    if (ts < st->first_ts) {
+        st->first_ts = ts;
+    }
+    if (ts > st->last_ts) {
+        st->last_ts = ts;
+    }
+    if (pc->fcs) {
+        if (caplen < 2) {
+            return;
+        }
+        end -= 2;
+    }
+    dst = wpan_decode(&p, end);
+    if (dst < 0) {
+        return;
+    }
+    nh = lowpan_decode(&p, end);
+    if (nh != ICMPV6_NH || p + 2 > end || p[0] != ICMP_RPL_TYPE) {
+        return;
+    }
+    code = p[1];
+    if (code >= RPL_MAX_CODE || dst > 0xffff) {
+        return;
+    }
+    cnt_t *c = &st->rpl[code][dst == WPAN_BCAST16 ? DST_MCAST : DST_UCAST];
+    c->pkts++;
+    c->bytes += origlen;
+}
+
+static inline int rec_valid(const pcap_t *pc, size_t off)
+{
+    const uint8_t *r = pc->base + off;
+    uint32_t       sec, frac, incl, orig;
+
+    if (off + PCAP_RHDR_LEN > pc->len) {
+        return 0;
+    }
+    sec  = rd32(pc, r);
+    frac = rd32(pc, r + 4);
+    incl = rd32(pc, r + 8);
+    orig = rd32(pc, r + 12);
+    if (frac >= (pc->nsec ? 1000000000u : 1000000u)) {
+        return 0;
+    }
+    if (incl > pc->snaplen || incl > orig || orig > 0x40000) {
+        return 0;
+    }
+    if (sec < pc->first_sec || sec - pc->first_sec > 100 * 86400) {
+        return 0;
+    }
+    return off + PCAP_RHDR_LEN + incl <= pc->len;
+}
+
+/* Finds the first record boundary at or after off */
+static size_t pcap_resync(const pcap_t *pc, size_t off)
+{
+    for (; off + PCAP_RHDR_LEN <= pc->len; off++) {
+        size_t o = off;
+        int    i;
+
+        for (i = 0; i < RESYNC_CHAIN; i++) {
+            if (!rec_valid(pc, o)) {
+                break;
+            }
+            o += PCAP_RHDR_LEN + rd32(pc, pc->base + o + 8);
+            if (o == pc->len) {
+                i = RESYNC_CHAIN;
+                break;
+            }
+        }
+        if (i == RESYNC_CHAIN) {
+            return off;
+        }
+    }
+    return pc->len;
+}
+
+/* Counts the records starting before stop, next is where the walk ended */
+static void pcap_walk(const pcap_t *pc, size_t off, size_t stop, stats_t *st, size_t *next)
+{
+    double div = pc->nsec ? 1e9 : 1e6;
+
+    memset(st, 0, sizeof(*st));
+    st->first_ts = 1e300;
+    while (off < stop && off + PCAP_RHDR_LEN <= pc->len) {
+        const uint8_t *r    = pc->base + off;
+        uint32_t       incl = rd32(pc, r + 8);
+
+        if (off + PCAP_RHDR_LEN + incl > pc->len) {
+            break; // reported by pcap_stats(), could be a false resync
+        }
+        handle_pkt(st, pc, r + PCAP_RHDR_LEN, incl, rd32(pc, r + 12),
+                   rd32(pc, r) + rd32(pc, r + 4) / div);
+        off += PCAP_RHDR_LEN + incl;
+    }
+    *next = off;
+}
+
+static int pcap_open(const char *fname, pcap_t *pc)
+{
+    struct stat st;
+    uint32_t    magic, dlt;
+    int         fd;
+
+    memset(pc, 0, sizeof(*pc));
+    fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "could not open %s: %m\n", fname);
+        return FAILURE;
+    }
+    if (fstat(fd, &st) || st.st_size < PCAP_GHDR_LEN) {
+        fprintf(stderr, "invalid pcap file %s\n", fname);
+        close(fd);
+        return FAILURE;
+    }
+    pc->len  = st.st_size;
+    pc->base = (const uint8_t *)mmap(NULL, pc->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (pc->base == MAP_FAILED) {
+        fprintf(stderr, "mmap failed %m\n");
+        return FAILURE;
+    }
+    madvise((void *)pc->base, pc->len, MADV_SEQUENTIAL);
+
+    memcpy(&magic, pc->base, 4);
+    if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+        pc->swap = 0;
+    } else if (__builtin_bswap32(magic) == PCAP_MAGIC_US || __builtin_bswap32(magic) == PCAP_MAGIC_NS) {
+        pc->swap = 1;
+        magic    = __builtin_bswap32(magic);
+    } else {
+        fprintf(stderr, "not a pcap file (magic=0x%08x)\n", magic);
+        return FAILURE;
+    }
+    pc->nsec    = (magic == PCAP_MAGIC_NS);
+    pc->snaplen = rd32(pc, pc->base + 16);
+    dlt         = rd32(pc, pc->base + 20) & 0x0fffffff;
+    if (!pc->snaplen) {
+        pc->snaplen = 0x40000;
+    }
+    if (dlt != DLT_WPAN_WITHFCS && dlt != DLT_WPAN_NOFCS && dlt != DLT_WPAN_NONASK) {
+        fprintf(stderr, "unsupported linktype %u, expected 802.15.4\n", dlt);
+        return FAILURE;
+    }
+    pc->fcs = (dlt == DLT_WPAN_WITHFCS);
+    if (pc->len >= PCAP_GHDR_LEN + PCAP_RHDR_LEN) {
+        pc->first_sec = rd32(pc, pc->base + PCAP_GHDR_LEN);
+    }
+    return SUCCESS;
+}
+
+static void stats_merge(stats_t *dst, const stats_t *src)
+{
+    for (int c = 0; c < RPL_MAX_CODE; c++) {
+        for (int d = 0; d < DST_MAX; d++) {
+            dst->rpl[c][d].pkts += src->rpl[c][d].pkts;
+            dst->rpl[c][d].bytes += src->rpl[c][d].bytes;
+        }
+    }
+    dst->tot_pkts += src->tot_pkts;
+    if (src->first_ts < dst->first_ts) {
+        dst->first_ts = src->first_ts;
+    }
+    if (src->last_ts > dst->last_ts) {
+        dst->last_ts = src->last_ts;
+    }
+}
+
+/*
+ * Every thread owns the records whose header starts in its byte range and
+ * starts at the first boundary pcap_resync() finds in it. If that was a
+ * false match, the previous thread ended elsewhere and the range is walked
+ * again from there, so no record is counted twice or missed.
+ */
+static void pcap_stats(const pcap_t *pc, int nthreads, stats_t *out)
+{
+    std::vector<size_t>      lo, start, next;
+    std::vector<stats_t>     part;
+    std::vector<std::thread> thr;
+    size_t                   datalen = pc->len - PCAP_GHDR_LEN;
+
+    if (nthreads < 1 || datalen < (size_t)nthreads * 65536) {
+        nthreads = 1;
+    }
+    for (int i = 0; i < nthreads; i++) {
+        lo.push_back(PCAP_GHDR_LEN + datalen / nthreads * i);
+        start.push_back(i ? pcap_resync(pc, lo[i]) : lo[i]);
+    }
+    lo.push_back(pc->len);
+    next.resize(nthreads);
+    part.resize(nthreads);
+    for (int i = 0; i < nthreads; i++) {
+        thr.push_back(std::thread(pcap_walk, pc, start[i], lo[i + 1], &part[i], &next[i]));
+    }
+    for (int i = 0; i < nthreads; i++) {
+        thr[i].join();
+    }
+    memset(out, 0, sizeof(*out));
+    out->first_ts = 1e300;
+    for (int i = 0; i < nthreads; i++) {
+        if (i && next[i - 1] != start[i]) {
+            pcap_walk(pc, next[i - 1], lo[i + 1], &part[i], &next[i]);
+        }
+        stats_merge(out, &part[i]);
+    }
+    if (next[nthreads - 1] + PCAP_RHDR_LEN <= pc->len) {
+        fprintf(stderr, "truncated record at offset %zu\n", next[nthreads - 1]);
+    }
+}
+
+static void json_cnt(FILE *fp, const char *name, const cnt_t *c)
+{
+    fprintf(fp,
+            "    \"%s\": {\n"
+            "        \"num_of_pkts\": \"%lu\",\n"
+            "        \"pkts_sz\": \"%lu\"\n"
+            "    },\n",
+            name, c->pkts, c->bytes);
+}
+
+static int json_dump(const char *fname, const stats_t *st)
+{
+    FILE *fp = fopen(fname, "w");
+
+    if (!fp) {
+        fprintf(stderr, "could not open %s for writing: %m\n", fname);
+        return FAILURE;
+    }
+    fprintf(fp, "{\n");
+    json_cnt(fp, "dis_mcast", &st->rpl[RPL_DIS][DST_MCAST]);
+    json_cnt(fp, "dis_ucast", &st->rpl[RPL_DIS][DST_UCAST]);
+    json_cnt(fp, "dio_mcast", &st->rpl[RPL_DIO][DST_MCAST]);
+    json_cnt(fp, "dio_ucast", &st->rpl[RPL_DIO][DST_UCAST]);
+    json_cnt(fp, "dao_ucast", &st->rpl[RPL_DAO][DST_UCAST]);
+    json_cnt(fp, "daoack_ucast", &st->rpl[RPL_DAOACK][DST_UCAST]);
+    fprintf(fp,
+            "    \"auxinfo\": {\n"
+            "        \"duration\": \"%f\"\n"
+            "    }\n"
+            "}\n",
+            st->tot_pkts ? st->last_ts - st->first_ts : 0.0);
+    fclose(fp);
+    return SUCCESS;
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s\n", prog);
+    printf("* -r|--read <pcap_fname>\n");
+    printf("  -w|--write <json_fname> (def: stats.json)\n");
+    printf("  -j|--jobs <num> ... split the pcap across <num> threads (def: 1)\n");
+    printf("* denotes mandatory args\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *         rfile = NULL, *wfile = "stats.json";
+    int                  jobs  = 1, c;
+    pcap_t               pc;
+    stats_t              st;
+    static struct option lopts[] = {
+        { "read", required_argument, 0, 'r' },
+        { "write", required_argument, 0, 'w' },
+        { "jobs", required_argument, 0, 'j' },
+        { 0, 0, 0, 0 },
+    };
+
+    while ((c = getopt_long(argc, argv, "r:w:j:", lopts, NULL)) != -1) {
+        switch (c) {
+        case 'r':
+            rfile = optarg;
+            break;
+        case 'w':
+            wfile = optarg;
+            break;
+        case 'j':
+            jobs = atoi(optarg);
+            if (jobs <= 0) {
+                jobs = std::thread::hardware_concurrency();
+            }
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (!rfile) {
+        usage(argv[0]);
+    }
+    if (pcap_open(rfile, &pc) != SUCCESS) {
+        return 1;
+    }
+    pcap_stats(&pc, jobs, &st);
+    munmap((void *)pc.base, pc.len);
+    if (json_dump(wfile, &st) != SUCCESS) {
+        return 1;
+    }
+    printf("done. check %s\n", wfile);
+    return 0;
+}
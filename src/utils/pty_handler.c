@@ -13,6 +13,19 @@
  * @file
  * @brief       OAM PTY handler thread in forker
  *
+ * Every PTY=1 node gets a listening unix stream socket $LOGPATH/XXXX.uds
+ * (XXXX is the hex node id). A client connecting to it is attached to the
+ * node's console; a new client takes over from the previous one. Console
+ * output is always drained from the pty so that the node never blocks on it.
+ * It is forwarded to the attached client and, with WF_PTY_SCROLLBACK=<bytes>,
+ * kept in a per node ring that is replayed on attach. All fds are non
+ * blocking and edge triggered.
+ *
+ * Sessions are owned by the pty thread. pty_add_node() hands a new session
+ * over through a pipe, and ci->pty_sess/pty_ring are only touched by the pty
+ * thread. A session closed while handling an epoll batch is freed only
+ * after the batch, since later events of the batch may still refer to it.
+ *
  * @author      Rahul Jadhav <nyrahul@gmail.com>
  *
  * @}
@@ -20,127 +33,358 @@
 
 #define _PTY_HANDLER_C_
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
 #include <pthread.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/epoll.h>
-#include <netinet/in.h>
+#include <poll.h>
 #include "commline/commline.h"
 #include "utils/forker_common.h"
 
-int                   g_pty_epollfd = -1;
-extern child_psinfo_t g_child_info[];
+enum {
+    PTY_EP_MASTER,
+    PTY_EP_LISTEN,
+    PTY_EP_CONN,
+};
+
+typedef struct _pty_ep_ {
+    struct _pty_sess_ *sess;
+    uint8_t            type;
+} pty_ep_t;
+
+typedef struct _pty_ring_ {
+    uint32_t size, head, used;
+    char     buf[];
+} pty_ring_t;
 
-#define MASTER_FD g_child_info[nodeid].master
-#define UDS_FD    g_child_info[nodeid].uds_fd
-#define PEER      g_child_info[nodeid].peer
-#define PEERLEN   g_child_info[nodeid].peerlen
-int handle_pty_event(int nodeid, int ismaster)
+typedef struct _pty_sess_ {
+    child_psinfo_t *   ci;
+    int                master, lfd, cfd;
+    pty_ep_t           ep[3];
+    uint8_t            closed;
+    struct _pty_sess_ *next; // in g_closed_sess
+} pty_sess_t;
+
+int                g_pty_epollfd = -1;
+static uint32_t    g_scrollback;
+static int         g_pty_addfd[2] = { -1, -1 }; // new sessions to the pty thread
+static pty_sess_t *g_closed_sess;
+
+static void ring_put(child_psinfo_t *ci, const char *data, uint32_t len)
 {
-    char buf[1024];
-    int  n;
+    pty_ring_t *r = ci->pty_ring;
+    uint32_t    n;
 
-    if (ismaster) {
-        n = read(MASTER_FD, buf, sizeof(buf));
-        INFO("master read n=%d, peerset=%d\n", n, PEERLEN);
-        INFO("master data:\n%.*s\n", n, buf);
-        if (n > 0 && PEERLEN) {
-            n = sendto(UDS_FD, buf, n, 0, (struct sockaddr *)&PEER, PEERLEN);
-        }
-    } else {
-        PEERLEN = sizeof(PEER);
-        n       = recvfrom(UDS_FD, buf, sizeof(buf), 0, (struct sockaddr *)&PEER, &PEERLEN);
-        INFO("uds read n=%d, peerset=%d\n", n, PEERLEN);
-        if (n > 0) {
-            n = write(MASTER_FD, buf, n);
-        } else {
-            PEERLEN = 0;
+    if (!g_scrollback) {
+        return;
+    }
+    if (!r) {
+        r = calloc(1, sizeof(*r) + g_scrollback);
+        if (!r) {
+            return;
         }
+        r->size      = g_scrollback;
+        ci->pty_ring = r;
     }
-    if (n <= 0) {
-        ERROR("[%m] nodeid:%d, write failed ismaster:%d n=%d\n", nodeid, ismaster, n);
-        return FAILURE;
+    if (len > r->size) {
+        data += len - r->size;
+        len = r->size;
+    }
+    while (len) {
+        n = r->size - r->head;
+        n = n < len ? n : len;
+        memcpy(r->buf + r->head, data, n);
+        r->head = (r->head + n) % r->size;
+        r->used = r->used + n > r->size ? r->size : r->used + n;
+        data += n;
+        len -= n;
     }
-    return SUCCESS;
 }
 
-#define MAXEVENTS 32
-void *pty_handler_thread(void *arg)
+/* Console output to a client that does not keep up is dropped rather than
+ * stalling every other console */
+static int write_all(int fd, const char *data, size_t len)
 {
-    int                n, i, nodeid, ismaster;
-    struct epoll_event events[MAXEVENTS];
+    ssize_t n;
 
-    memset(events, 0, sizeof(events));
-    for (;;) {
-        n = epoll_wait(g_pty_epollfd, events, MAXEVENTS, -1);
-        if (n <= 0) {
-            ERROR("epoll_wait return n=%d\n", n);
-            usleep(10000);
+    while (len) {
+        n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
             continue;
         }
-        for (i = 0; i < n; i++) {
-            nodeid   = events[i].data.u32 & 0x7fffffff;
-            ismaster = events[i].data.u32 & 0x80000000;
-            handle_pty_event(nodeid, ismaster);
+        if (n <= 0) {
+            return FAILURE;
         }
+        data += n;
+        len -= n;
     }
+    return SUCCESS;
 }
 
-int pty_add_fd(int nodeid, int fd, int ismaster)
+static void ring_replay(child_psinfo_t *ci, int fd)
 {
-    struct epoll_event ev;
+    pty_ring_t *r = ci->pty_ring;
+    uint32_t    beg;
 
-    ev.events = EPOLLIN;
+    if (!r || !r->used) {
+        return;
+    }
+    beg = (r->head + r->size - r->used) % r->size;
+    if (beg + r->used <= r->size) {
+        write_all(fd, r->buf + beg, r->used);
+    } else {
+        write_all(fd, r->buf + beg, r->size - beg);
+        write_all(fd, r->buf, r->head);
+    }
+}
 
-    //We need this first bit to differentiate between master fd versus uds_fd
-    ev.data.u32 = ((uint32_t)nodeid | (ismaster ? 0x80000000 : 0));
+static int ep_add(pty_sess_t *s, int fd, uint8_t type)
+{
+    struct epoll_event ev;
+
+    s->ep[type].sess = s;
+    s->ep[type].type = type;
+    ev.events        = EPOLLIN | EPOLLET;
+    ev.data.ptr      = &s->ep[type];
     if (epoll_ctl(g_pty_epollfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
-        ERROR("epoll_ctl failed nodeid:%d, fd:%d %m\n", nodeid, fd);
+        ERROR("epoll_ctl failed nodeid:%u fd:%d %m\n", s->ci->nodeid, fd);
         return FAILURE;
     }
     return SUCCESS;
 }
 
-int start_pty_thread(void)
+static void ep_close(int *fd)
 {
-    pthread_t tid;
+    if (*fd >= 0) {
+        epoll_ctl(g_pty_epollfd, EPOLL_CTL_DEL, *fd, NULL);
+        CLOSE(*fd);
+    }
+}
 
-    g_pty_epollfd = epoll_create1(0);
-    if (g_pty_epollfd < 0) {
-        ERROR("failed creating epollfd %m\n");
-        return FAILURE;
+int uds_get_path(int nodeid, char *path, int maxlen)
+{
+    char *logpath = getenv("LOGPATH");
+
+    return snprintf(path, maxlen, "%s/%04x.uds", logpath ? logpath : "log", nodeid);
+}
+
+/* Node exited, its pty returns EIO. The session is freed after the current
+ * epoll batch by pty_sess_reap(). */
+static void pty_sess_close(pty_sess_t *s)
+{
+    char path[108];
+
+    if (s->closed) {
+        return;
+    }
+    ep_close(&s->cfd);
+    ep_close(&s->lfd);
+    ep_close(&s->master);
+    if (s->ci->pty_sess == s) { // else a respawned node owns the path now
+        uds_get_path(s->ci->nodeid, path, sizeof(path));
+        unlink(path);
+        s->ci->pty_sess = NULL;
     }
+    s->closed     = 1;
+    s->next       = g_closed_sess;
+    g_closed_sess = s;
+}
 
-    if (pthread_create(&tid, NULL, pty_handler_thread, NULL)) {
-        ERROR("failure creating pty handler thread %m\n");
-        CLOSE(g_pty_epollfd);
+static void pty_sess_reap(void)
+{
+    pty_sess_t *s;
+
+    while ((s = g_closed_sess)) {
+        g_closed_sess = s->next;
+        free(s);
+    }
+}
+
+/* Returns FAILURE if the node's pty is gone and the session was closed */
+static int handle_master(pty_sess_t *s)
+{
+    char    buf[16 * 1024];
+    ssize_t n;
+
+    for (;;) {
+        n = read(s->master, buf, sizeof(buf));
+        if (n > 0) {
+            ring_put(s->ci, buf, n);
+            if (s->cfd >= 0 && write_all(s->cfd, buf, n) != SUCCESS && errno != EAGAIN) {
+                ep_close(&s->cfd);
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            return SUCCESS;
+        }
+        pty_sess_close(s);
         return FAILURE;
     }
-    pthread_detach(tid);
+}
+
+/* The node may itself be blocked writing its echo to a full pty, so drain
+ * its output while waiting for room. Input that still does not fit within
+ * 100ms (e.g. an over long line in canonical mode) is dropped. */
+static int pty_input(pty_sess_t *s, const char *data, size_t len)
+{
+    struct pollfd pfd = { .fd = s->master, .events = POLLOUT };
+    ssize_t       n;
+
+    while (len) {
+        n = write(s->master, data, len);
+        if (n > 0) {
+            data += n;
+            len -= n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            if (SUCCESS != handle_master(s)) {
+                return FAILURE;
+            }
+            if (poll(&pfd, 1, 100) > 0) {
+                continue;
+            }
+        }
+        break;
+    }
     return SUCCESS;
 }
 
-int uds_get_path(int nodeid, char *path, int maxlen)
+static void handle_listen(pty_sess_t *s)
 {
-    char *logpath      = getenv("LOGPATH");
-    char *monitor_port = getenv("MONITOR_PORT");
+    int fd;
 
-    return snprintf(path, maxlen, "%s/%s_%04x.unixsock",
-                    logpath ? logpath : "/tmp",
-                    monitor_port, nodeid);
+    while ((fd = accept4(s->lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        if (s->cfd >= 0) {
+            write_all(s->cfd, "\r\n[detached, another client attached]\r\n",
+                      sizeof("\r\n[detached, another client attached]\r\n") - 1);
+            ep_close(&s->cfd);
+        }
+        ring_replay(s->ci, fd);
+        if (SUCCESS != ep_add(s, fd, PTY_EP_CONN)) {
+            close(fd);
+            continue;
+        }
+        s->cfd = fd;
+    }
+}
+
+static void handle_conn(pty_sess_t *s)
+{
+    char    buf[4096];
+    ssize_t n;
+
+    for (;;) {
+        n = read(s->cfd, buf, sizeof(buf));
+        if (n > 0) {
+            if (SUCCESS != pty_input(s, buf, n)) {
+                return;
+            }
+            continue;
+        }
+        if (n < 0 && (errno == EINTR)) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            return;
+        }
+        ep_close(&s->cfd); // client detached
+        return;
+    }
+}
+
+static int uds_open(int nodeid);
+
+/* Binds the console socket and makes the session the node's current one.
+ * The socket is bound here so that the close of the previous instance's
+ * session cannot unlink the new socket path. */
+static void pty_sess_start(pty_sess_t *s)
+{
+    child_psinfo_t *ci = s->ci;
+
+    s->lfd = uds_open(ci->nodeid);
+    if (s->lfd < 0) {
+        // no console, still drain the pty so that the node does not block
+        ERROR("nodeid:%u console not available\n", ci->nodeid);
+    }
+    ci->pty_sess = s;
+    if ((s->lfd >= 0 && SUCCESS != ep_add(s, s->lfd, PTY_EP_LISTEN)) ||
+        SUCCESS != ep_add(s, s->master, PTY_EP_MASTER)) {
+        pty_sess_close(s);
+    }
+}
+
+static void handle_add(void)
+{
+    pty_sess_t *s;
+
+    while (read(g_pty_addfd[0], &s, sizeof(s)) == sizeof(s)) {
+        pty_sess_start(s);
+    }
+}
+
+#define MAXEVENTS 256
+void *pty_handler_thread(void *arg)
+{
+    int                n, i;
+    pty_ep_t *         ep;
+    struct epoll_event events[MAXEVENTS];
+
+    for (;;) {
+        n = epoll_wait(g_pty_epollfd, events, MAXEVENTS, -1);
+        if (n < 0 && errno != EINTR) {
+            ERROR("epoll_wait failed %m\n");
+            usleep(10000);
+        }
+        for (i = 0; i < n; i++) {
+            ep = events[i].data.ptr;
+            if (!ep) {
+                handle_add();
+                continue;
+            }
+            if (ep->sess->closed) {
+                continue;
+            }
+            switch (ep->type) {
+            case PTY_EP_MASTER:
+                (void)handle_master(ep->sess);
+                break;
+            case PTY_EP_LISTEN:
+                handle_listen(ep->sess);
+                break;
+            case PTY_EP_CONN:
+                handle_conn(ep->sess);
+                break;
+            }
+        }
+        pty_sess_reap();
+    }
+    return NULL;
 }
 
-int uds_open(int nodeid)
+static int uds_open(int nodeid)
 {
     struct sockaddr_un addr;
     int                fd;
 
-    fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (fd == -1) {
         ERROR("UDS socket failed %m\n");
         return FAILURE;
@@ -150,11 +394,82 @@ int uds_open(int nodeid)
     uds_get_path(nodeid, addr.sun_path, sizeof(addr.sun_path));
     unlink(addr.sun_path);
 
-    INFO("binding to unix domain sock:[%s]\n", addr.sun_path);
-    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, 4) == -1) {
+        ERROR("UDS bind/listen error [%s] %m\n", addr.sun_path);
         CLOSE(fd);
-        ERROR("UDS bind error %m");
         return FAILURE;
     }
     return fd;
 }
+
+/* Takes over the pty master of a freshly forked PTY=1 node and hands it to
+ * the pty thread */
+int pty_add_node(child_psinfo_t *ci)
+{
+    struct termios tios;
+    pty_sess_t *   s = calloc(1, sizeof(*s));
+
+    if (!s) {
+        return FAILURE;
+    }
+    s->ci     = ci;
+    s->master = ci->master;
+    s->lfd    = -1;
+    s->cfd    = -1;
+    ci->master = -1;
+
+    tcgetattr(s->master, &tios);
+    tios.c_lflag &= ~(ECHO | ECHONL);
+    tcsetattr(s->master, TCSAFLUSH, &tios);
+    fcntl(s->master, F_SETFL, fcntl(s->master, F_GETFL) | O_NONBLOCK);
+    fcntl(s->master, F_SETFD, FD_CLOEXEC);
+
+    // a pointer is less than PIPE_BUF, the write is atomic
+    if (write(g_pty_addfd[1], &s, sizeof(s)) != sizeof(s)) {
+        ERROR("nodeid:%u pty handover failed %m\n", ci->nodeid);
+        CLOSE(s->master);
+        free(s);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+int start_pty_thread(void)
+{
+    pthread_t          tid;
+    char *             ptr = getenv("WF_PTY_SCROLLBACK");
+    struct epoll_event ev;
+
+    g_scrollback  = ptr ? strtoul(ptr, NULL, 10) : 0;
+    g_pty_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_pty_epollfd < 0) {
+        ERROR("failed creating epollfd %m\n");
+        return FAILURE;
+    }
+    if (pipe2(g_pty_addfd, O_CLOEXEC)) {
+        ERROR("failed creating pty handover pipe %m\n");
+        CLOSE(g_pty_epollfd);
+        return FAILURE;
+    }
+    fcntl(g_pty_addfd[0], F_SETFL, O_NONBLOCK);
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLET;
+    ev.data.ptr = NULL; // handover pipe
+    if (epoll_ctl(g_pty_epollfd, EPOLL_CTL_ADD, g_pty_addfd[0], &ev) == -1) {
+        ERROR("epoll_ctl failed for pty handover pipe %m\n");
+        CLOSE(g_pty_addfd[0]);
+        CLOSE(g_pty_addfd[1]);
+        CLOSE(g_pty_epollfd);
+        return FAILURE;
+    }
+
+    if (pthread_create(&tid, NULL, pty_handler_thread, NULL)) {
+        ERROR("failure creating pty handler thread %m\n");
+        CLOSE(g_pty_addfd[0]);
+        CLOSE(g_pty_addfd[1]);
+        CLOSE(g_pty_epollfd);
+        return FAILURE;
+    }
+    pthread_detach(tid);
+    return SUCCESS;
+}
@@ -0,0 +1,530 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     commline
+ * @{
+ *
+ * @file
+ * @brief       Commline microbenchmark
+ *
+ * The process acts as the airline and forks N fake stacklines. Frames carry
+ * their send time and every receive is recorded in a log-linear latency
+ * histogram in shared memory. Patterns:
+ *   up     every stackline sends to the airline (N -> 1)
+ *   down   the airline sends to the stacklines round robin (1 -> N)
+ *   bcast  the airline sends every frame to all stacklines (1 -> all)
+ *   echo   stacklines send to the airline which sends the frame back,
+ *          latency is the round trip, one frame outstanding per stackline
+ * CPU per message is the user+sys time of all the processes divided by the
+ * frames received. It uses the same socket names/msgq key as whitefield, so
+ * it cannot run while whitefield runs as the same user in the same dir.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "commline/commline.h"
+#include "commline/cl_usock.h"
+
+/* Both transports are in libwf_commline, cl_msgq.h would redefine CL_* */
+int  msgq_init(const cl_mtype_t my_mtype, const uint8_t flags);
+void msgq_cleanup(void);
+int  msgq_recvfrom(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags);
+int  msgq_sendto(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len);
+
+typedef struct _cl_ops_ {
+    const char *name;
+    int (*init)(const cl_mtype_t my_mtype, const uint8_t flags);
+    void (*cleanup)(void);
+    int (*sendto)(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len);
+    int (*recvfrom)(const cl_mtype_t mtype, msg_buf_t *mbuf, uint16_t len, uint16_t flags);
+    int max_nodes;
+} cl_ops_t;
+
+static cl_ops_t g_ops[] = {
+    { "usock", usock_init, usock_cleanup, usock_sendto, usock_recvfrom, 100000 },
+    { "msgq", msgq_init, msgq_cleanup, msgq_sendto, msgq_recvfrom, CL_LEGACY_MAX_ID },
+};
+
+enum {
+    PAT_UP,
+    PAT_DOWN,
+    PAT_BCAST,
+    PAT_ECHO,
+    PAT_MAX,
+};
+
+static const char *g_pat_name[PAT_MAX] = { "up", "down", "bcast", "echo" };
+
+/* log2 buckets with 16 linear sub buckets, ~6% resolution */
+#define HIST_SUB     16
+#define HIST_BUCKETS (61 * HIST_SUB)
+
+typedef struct _proc_stats_ {
+    uint64_t cnt;
+    uint64_t end_ns;
+    uint64_t hist[HIST_BUCKETS];
+} proc_stats_t;
+
+typedef struct _bench_shm_ {
+    uint64_t     beg_ns;
+    proc_stats_t st[]; // [0] is the airline, [1..nodes] the stacklines
+} bench_shm_t;
+
+typedef struct _run_ {
+    cl_ops_t *   ops;
+    int          pat;
+    int          nodes;
+    int          size;
+    uint64_t     msgs;
+    bench_shm_t *shm;
+} run_t;
+
+static int g_json, g_verbose, g_timeout = 60;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int hist_idx(uint64_t v)
+{
+    int e;
+
+    if (v < HIST_SUB) {
+        return v;
+    }
+    e = 63 - __builtin_clzll(v);
+    return (e - 3) * HIST_SUB + ((v >> (e - 4)) & (HIST_SUB - 1));
+}
+
+static uint64_t hist_val(int idx)
+{
+    int e = idx / HIST_SUB + 3;
+
+    if (idx < HIST_SUB) {
+        return idx;
+    }
+    return (1ULL << e) | ((uint64_t)(idx % HIST_SUB) << (e - 4));
+}
+
+static void rec_latency(proc_stats_t *st, msg_buf_t *mbuf)
+{
+    uint64_t sent;
+
+    memcpy(&sent, mbuf->buf, sizeof(sent));
+    st->hist[hist_idx(now_ns() - sent)]++;
+    st->cnt++;
+    st->end_ns = now_ns();
+}
+
+/* hdr_ver is left 0: with USE_UNIX_SOCKETS mtype is an int and msgsnd()
+ * takes the following hdr_ver/rsvd as the upper half of its long mtype. */
+static void fill_frame(msg_buf_t *mbuf, cl_nodeid_t src, cl_nodeid_t dst, int size)
+{
+    uint64_t t = now_ns();
+
+    mbuf->src_id  = src;
+    mbuf->dst_id  = dst;
+    mbuf->len     = size;
+    memcpy(mbuf->buf, &t, sizeof(t));
+}
+
+/* Blocks till the parent closes the write end */
+static void gate_wait(int fd)
+{
+    char c;
+
+    while (read(fd, &c, 1) > 0)
+        ;
+}
+
+static void stackline(run_t *r, int id, int gate_init, int gate_start, int ready)
+{
+    DEFINE_MBUF(mbuf);
+    proc_stats_t *st  = &r->shm->st[id + 1];
+    cl_mtype_t    me  = MTYPE(STACKLINE, id);
+    cl_mtype_t    al  = MTYPE(AIRLINE, CL_MGR_ID);
+    uint64_t      cnt = r->msgs / r->nodes + (id < (int)(r->msgs % r->nodes));
+    uint64_t      i;
+
+    gate_wait(gate_init);
+    if (r->ops->init(me, CL_ATTACHQ) != SUCCESS) {
+        _exit(1);
+    }
+    if (write(ready, "r", 1) != 1) {
+        _exit(1);
+    }
+    gate_wait(gate_start);
+    switch (r->pat) {
+    case PAT_UP:
+        for (i = 0; i < cnt; i++) {
+            fill_frame(mbuf, id, CL_MGR_ID, r->size);
+            if (r->ops->sendto(al, mbuf, sizeof(msg_buf_t) + r->size) != SUCCESS) {
+                _exit(1);
+            }
+        }
+        break;
+    case PAT_BCAST:
+        cnt = r->msgs;
+        // fall through
+    case PAT_DOWN:
+        for (i = 0; i < cnt; i++) {
+            if (r->ops->recvfrom(me, mbuf, sizeof(mbuf_buf), 0) <= 0) {
+                _exit(1);
+            }
+            rec_latency(st, mbuf);
+        }
+        break;
+    case PAT_ECHO:
+        for (i = 0; i < cnt; i++) {
+            fill_frame(mbuf, id, CL_MGR_ID, r->size);
+            if (r->ops->sendto(al, mbuf, sizeof(msg_buf_t) + r->size) != SUCCESS ||
+                r->ops->recvfrom(me, mbuf, sizeof(mbuf_buf), 0) <= 0) {
+                _exit(1);
+            }
+            rec_latency(st, mbuf);
+        }
+        break;
+    }
+    _exit(0);
+}
+
+static int airline(run_t *r)
+{
+    DEFINE_MBUF(mbuf);
+    proc_stats_t *st = &r->shm->st[0];
+    cl_mtype_t    me = MTYPE(AIRLINE, CL_MGR_ID);
+    uint64_t      i;
+    int           n;
+
+    switch (r->pat) {
+    case PAT_UP:
+        for (i = 0; i < r->msgs; i++) {
+            if (r->ops->recvfrom(me, mbuf, sizeof(mbuf_buf), 0) <= 0) {
+                return FAILURE;
+            }
+            rec_latency(st, mbuf);
+        }
+        break;
+    case PAT_DOWN:
+        for (i = 0; i < r->msgs; i++) {
+            fill_frame(mbuf, CL_MGR_ID, i % r->nodes, r->size);
+            if (r->ops->sendto(MTYPE(STACKLINE, i % r->nodes), mbuf,
+                               sizeof(msg_buf_t) + r->size) != SUCCESS) {
+                return FAILURE;
+            }
+        }
+        break;
+    case PAT_BCAST:
+        for (i = 0; i < r->msgs; i++) {
+            fill_frame(mbuf, CL_MGR_ID, CL_BCAST_ID, r->size);
+            for (n = 0; n < r->nodes; n++) {
+                if (r->ops->sendto(MTYPE(STACKLINE, n), mbuf,
+                                   sizeof(msg_buf_t) + r->size) != SUCCESS) {
+                    return FAILURE;
+                }
+            }
+        }
+        break;
+    case PAT_ECHO:
+        for (i = 0; i < r->msgs; i++) {
+            if (r->ops->recvfrom(me, mbuf, sizeof(mbuf_buf), 0) <= 0 ||
+                r->ops->sendto(MTYPE(STACKLINE, mbuf->src_id), mbuf,
+                               sizeof(msg_buf_t) + mbuf->len) != SUCCESS) {
+                return FAILURE;
+            }
+        }
+        break;
+    }
+    return SUCCESS;
+}
+
+static uint64_t cpu_us(int who)
+{
+    struct rusage ru;
+
+    getrusage(who, &ru);
+    return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 +
+           ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+static double pct(uint64_t *hist, uint64_t total, double p)
+{
+    uint64_t want = (uint64_t)(total * p), sum = 0;
+    int      i;
+
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        sum += hist[i];
+        if (sum > want) {
+            return hist_val(i) / 1000.0;
+        }
+    }
+    return 0;
+}
+
+static void report(run_t *r, uint64_t cpu)
+{
+    proc_stats_t *st = r->shm->st;
+    uint64_t      hist[HIST_BUCKETS] = { 0 }, cnt = 0, beg_ns = r->shm->beg_ns, end_ns = beg_ns;
+    double        secs;
+    int           i, b;
+
+    for (i = 0; i <= r->nodes; i++) {
+        cnt += st[i].cnt;
+        end_ns = st[i].end_ns > end_ns ? st[i].end_ns : end_ns;
+        for (b = 0; b < HIST_BUCKETS; b++) {
+            hist[b] += st[i].hist[b];
+        }
+    }
+    secs = (end_ns - beg_ns) / 1e9;
+    if (g_json) {
+        printf("{\"transport\":\"%s\",\"pattern\":\"%s\",\"nodes\":%d,\"size\":%d,"
+               "\"msgs\":%" PRIu64 ",\"msgs_per_sec\":%.0f,\"p50_us\":%.1f,\"p99_us\":%.1f,"
+               "\"p999_us\":%.1f,\"cpu_us_per_msg\":%.2f}\n",
+               r->ops->name, g_pat_name[r->pat], r->nodes, r->size, cnt,
+               secs > 0 ? cnt / secs : 0, pct(hist, cnt, 0.5), pct(hist, cnt, 0.99),
+               pct(hist, cnt, 0.999), cnt ? (double)cpu / cnt : 0);
+        return;
+    }
+    printf("%-6s %-6s %6d %6d %9" PRIu64 " %10.0f %9.1f %9.1f %9.1f %8.2f\n",
+           r->ops->name, g_pat_name[r->pat], r->nodes, r->size, cnt,
+           secs > 0 ? cnt / secs : 0, pct(hist, cnt, 0.5), pct(hist, cnt, 0.99),
+           pct(hist, cnt, 0.999), cnt ? (double)cpu / cnt : 0);
+}
+
+/* The run forks its own airline process so that every run starts with fresh
+ * commline state and its cpu time shows up in RUSAGE_CHILDREN here. */
+static void run_airline(run_t *r)
+{
+    int   gate_init[2], gate_start[2], ready[2], i, status, ret = SUCCESS;
+    pid_t pids[r->nodes];
+    char  c;
+
+    alarm(g_timeout);
+    if (!g_verbose && !freopen("/dev/null", "w", stdout)) {
+        _exit(1);
+    }
+    if (pipe(gate_init) || pipe(gate_start) || pipe(ready)) {
+        perror("pipe");
+        _exit(1);
+    }
+    for (i = 0; i < r->nodes; i++) {
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            perror("fork");
+            r->nodes = i;
+            ret      = FAILURE;
+            break;
+        }
+        if (!pids[i]) {
+            alarm(g_timeout);
+            close(gate_init[1]);
+            close(gate_start[1]);
+            close(ready[0]);
+            stackline(r, i, gate_init[0], gate_start[0], ready[1]);
+        }
+    }
+    close(gate_init[0]);
+    close(gate_start[0]);
+    close(ready[1]);
+    if (ret == SUCCESS && r->ops->init(MTYPE(AIRLINE, CL_MGR_ID), CL_CREATEQ) != SUCCESS) {
+        fprintf(stderr, "%s: airline init failed, is whitefield running?\n", r->ops->name);
+        ret = FAILURE;
+    }
+    close(gate_init[1]);
+    for (i = 0; ret == SUCCESS && i < r->nodes; i++) {
+        if (read(ready[0], &c, 1) != 1) {
+            fprintf(stderr, "%s: stackline init failed\n", r->ops->name);
+            ret = FAILURE;
+        }
+    }
+    if (ret != SUCCESS) {
+        for (i = 0; i < r->nodes; i++) {
+            kill(pids[i], SIGKILL);
+        }
+    }
+    r->shm->beg_ns = now_ns();
+    close(gate_start[1]);
+    if (ret == SUCCESS && airline(r) != SUCCESS) {
+        fprintf(stderr, "%s: airline send/recv failed\n", r->ops->name);
+        ret = FAILURE;
+    }
+    for (i = 0; i < r->nodes; i++) {
+        if (waitpid(pids[i], &status, 0) != pids[i] || !WIFEXITED(status) ||
+            WEXITSTATUS(status)) {
+            ret = FAILURE;
+        }
+    }
+    r->ops->cleanup();
+    _exit(ret == SUCCESS ? 0 : 1);
+}
+
+static int run(run_t *r)
+{
+    size_t   shm_sz = sizeof(bench_shm_t) + (r->nodes + 1) * sizeof(proc_stats_t);
+    uint64_t cpu0   = cpu_us(RUSAGE_CHILDREN);
+    int      status, ret = FAILURE;
+    pid_t    pid;
+
+    r->shm = mmap(NULL, shm_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (r->shm == MAP_FAILED) {
+        perror("mmap");
+        return FAILURE;
+    }
+    fflush(NULL);
+    pid = fork();
+    if (!pid) {
+        run_airline(r);
+    }
+    if (pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && !WEXITSTATUS(status)) {
+        report(r, cpu_us(RUSAGE_CHILDREN) - cpu0);
+        ret = SUCCESS;
+    } else {
+        fprintf(stderr, "%s %s nodes=%d size=%d: run failed\n", r->ops->name,
+                g_pat_name[r->pat], r->nodes, r->size);
+    }
+    munmap(r->shm, shm_sz);
+    return ret;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-t usock,msgq] [-p up,down,bcast,echo] [-n nodes,...] [-s sizes,...]\n"
+            "       [-m msgs] [-T timeout_sec] [-j] [-v]\n"
+            "  -t  transports, default all compiled in libwf_commline\n"
+            "  -p  traffic patterns, default all\n"
+            "  -n  number of fake stacklines, default 10\n"
+            "  -s  frame payload sizes in bytes, default 16,127,1024\n"
+            "  -m  frames sent per run, default 20000\n"
+            "  -T  abort a run after this many seconds, default 60\n"
+            "  -j  one JSON object per run instead of the table\n"
+            "  -v  keep the commline logs of the fake nodes\n",
+            prog);
+}
+
+static int in_list(const char *list, const char *name)
+{
+    char buf[256], *tok, *save;
+
+    if (!list) {
+        return 1;
+    }
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        if (!strcmp(tok, name)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int parse_ints(const char *list, int *out, int max)
+{
+    char buf[256], *tok, *save;
+    int  n = 0;
+
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (tok = strtok_r(buf, ",", &save); tok && n < max; tok = strtok_r(NULL, ",", &save)) {
+        out[n++] = atoi(tok);
+    }
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *transports = NULL, *patterns = NULL;
+    int         nodes[16] = { 10 }, sizes[16] = { 16, 127, 1024 };
+    int         nnodes = 1, nsizes = 3, opt, t, p, n, s, ret = 0;
+    run_t       r;
+
+    memset(&r, 0, sizeof(r));
+    r.msgs = 20000;
+    while ((opt = getopt(argc, argv, "t:p:n:s:m:T:jvh")) != -1) {
+        switch (opt) {
+        case 't':
+            transports = optarg;
+            break;
+        case 'p':
+            patterns = optarg;
+            break;
+        case 'n':
+            nnodes = parse_ints(optarg, nodes, 16);
+            break;
+        case 's':
+            nsizes = parse_ints(optarg, sizes, 16);
+            break;
+        case 'm':
+            r.msgs = strtoull(optarg, NULL, 0);
+            break;
+        case 'T':
+            g_timeout = atoi(optarg);
+            break;
+        case 'j':
+            g_json = 1;
+            break;
+        case 'v':
+            g_verbose = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!g_json) {
+        printf("%-6s %-6s %6s %6s %9s %10s %9s %9s %9s %8s\n", "trans", "patt", "nodes", "size",
+               "rcvd", "msgs/s", "p50_us", "p99_us", "p999_us", "cpu_us");
+    }
+    for (t = 0; t < (int)(sizeof(g_ops) / sizeof(g_ops[0])); t++) {
+        if (!in_list(transports, g_ops[t].name)) {
+            continue;
+        }
+        r.ops = &g_ops[t];
+        for (p = 0; p < PAT_MAX; p++) {
+            if (!in_list(patterns, g_pat_name[p])) {
+                continue;
+            }
+            r.pat = p;
+            for (n = 0; n < nnodes; n++) {
+                for (s = 0; s < nsizes; s++) {
+                    r.nodes = nodes[n];
+                    r.size  = sizes[s];
+                    if (r.nodes < 1 || r.nodes > r.ops->max_nodes || r.size < (int)sizeof(uint64_t) ||
+                        r.size > COMMLINE_MAX_BUF) {
+                        fprintf(stderr, "%s: skipping nodes=%d size=%d, out of range\n",
+                                r.ops->name, r.nodes, r.size);
+                        continue;
+                    }
+                    if (run(&r) != SUCCESS) {
+                        ret = 1;
+                    }
+                }
+            }
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       Reader for the aggregated node log (nodes.wflog)
+ *
+ * Usage: wf_logread [-n <id>[-<id>]] [-s <sec>] [-e <sec>] [-a] [file...]
+ * -s/-e are seconds since the first record of the first file. Rotated files
+ * should be given oldest first.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <zlib.h>
+#include "utils/wflog.h"
+
+typedef struct _filter_ {
+    uint32_t node_min, node_max;
+    double   beg_sec, end_sec;
+    uint64_t base_us; // time of the first record seen
+    int      abs_time;
+} filter_t;
+
+static void print_rec(filter_t *f, const wflog_rec_t *rec, const char *line)
+{
+    char      tbuf[32];
+    time_t    sec;
+    struct tm tm;
+
+    if (f->abs_time) {
+        sec = rec->t_us / 1000000;
+        localtime_r(&sec, &tm);
+        strftime(tbuf, sizeof(tbuf), "%F %T", &tm);
+        printf("%s.%06" PRIu64 " %u: %.*s\n", tbuf, rec->t_us % 1000000,
+               rec->nodeid, rec->len, line);
+    } else {
+        printf("%12.6f %u: %.*s\n", (int64_t)(rec->t_us - f->base_us) / 1e6,
+               rec->nodeid, rec->len, line);
+    }
+}
+
+static int read_file(const char *path, filter_t *f)
+{
+    FILE *        fp = fopen(path, "r");
+    wflog_chunk_t ch;
+    wflog_rec_t   rec;
+    uint8_t *     cbuf = NULL, *ubuf = NULL;
+    uLong         ulen;
+    uint32_t      off, i;
+    int           ret = 0;
+
+    if (!fp) {
+        perror(path);
+        return 1;
+    }
+    ubuf = malloc(WFLOG_CHUNK_SZ);
+    cbuf = malloc(compressBound(WFLOG_CHUNK_SZ));
+    if (!ubuf || !cbuf) {
+        ret = 1;
+        goto done;
+    }
+    while (fread(&ch, sizeof(ch), 1, fp) == 1) {
+        if (ch.magic != WFLOG_MAGIC || ch.ulen > WFLOG_CHUNK_SZ ||
+            ch.clen > compressBound(WFLOG_CHUNK_SZ)) {
+            fprintf(stderr, "%s: corrupt chunk at offset %ld\n", path, ftell(fp) - (long)sizeof(ch));
+            ret = 1;
+            break;
+        }
+        if (!f->base_us) {
+            f->base_us = ch.t_first_us;
+        }
+        // chunk level filtering without decompressing
+        if (ch.node_max < f->node_min || ch.node_min > f->node_max ||
+            (int64_t)(ch.t_last_us - f->base_us) / 1e6 < f->beg_sec ||
+            (int64_t)(ch.t_first_us - f->base_us) / 1e6 > f->end_sec) {
+            if (fseek(fp, ch.clen, SEEK_CUR)) {
+                break;
+            }
+            continue;
+        }
+        if (fread(cbuf, ch.clen, 1, fp) != 1) {
+            fprintf(stderr, "%s: truncated chunk\n", path);
+            break;
+        }
+        ulen = WFLOG_CHUNK_SZ;
+        if (uncompress(ubuf, &ulen, cbuf, ch.clen) != Z_OK || ulen != ch.ulen) {
+            fprintf(stderr, "%s: chunk decompress failed\n", path);
+            ret = 1;
+            continue;
+        }
+        for (off = 0, i = 0; i < ch.nrec && off + sizeof(rec) <= ulen; i++) {
+            double t;
+
+            memcpy(&rec, ubuf + off, sizeof(rec));
+            off += sizeof(rec);
+            if (off + rec.len > ulen) {
+                break;
+            }
+            t = (int64_t)(rec.t_us - f->base_us) / 1e6;
+            if (rec.nodeid >= f->node_min && rec.nodeid <= f->node_max &&
+                t >= f->beg_sec && t <= f->end_sec) {
+                print_rec(f, &rec, (char *)ubuf + off);
+            }
+            off += rec.len;
+        }
+    }
+done:
+    free(cbuf);
+    free(ubuf);
+    fclose(fp);
+    return ret;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-n <id>[-<id>]] [-s <sec>] [-e <sec>] [-a] [file...]\n"
+            "  -n  node id or range (decimal)\n"
+            "  -s  start time, seconds since the first record\n"
+            "  -e  end time, seconds since the first record\n"
+            "  -a  print absolute timestamps\n"
+            "  file defaults to $LOGPATH/" WFLOG_FILE ". Give rotated files oldest first.\n",
+            prog);
+}
+
+int main(int argc, char *argv[])
+{
+    filter_t f = { 0, UINT32_MAX, 0, 1e18, 0, 0 };
+    char     def[512], *ptr;
+    int      opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "n:s:e:ah")) != -1) {
+        switch (opt) {
+        case 'n':
+            f.node_min = f.node_max = strtoul(optarg, &ptr, 10);
+            if (*ptr == '-') {
+                f.node_max = strtoul(ptr + 1, NULL, 10);
+            }
+            break;
+        case 's':
+            f.beg_sec = atof(optarg);
+            break;
+        case 'e':
+            f.end_sec = atof(optarg);
+            break;
+        case 'a':
+            f.abs_time = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        snprintf(def, sizeof(def), "%s/" WFLOG_FILE, getenv("LOGPATH") ? getenv("LOGPATH") : "log");
+        return read_file(def, &f);
+    }
+    for (; optind < argc; optind++) {
+        ret |= read_file(argv[optind], &f);
+    }
+    return ret;
+}
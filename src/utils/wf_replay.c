@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Replays a stackline recording (recordFile=) into the airline
+ *
+ * Usage: wf_replay [-s <speed>] [-l <loops>] <file>
+ * The airline has to run with replayMode=1 and the same config as the
+ * recorded run. Frames are sent to the airline with their recorded spacing,
+ * scaled by the speed factor; speed 0 sends them as fast as possible.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include "commline/commline.h"
+#include "utils/wfrecord.h"
+
+static volatile sig_atomic_t g_stop;
+
+static void sig_handler(int signum)
+{
+    g_stop = 1;
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleep_until(uint64_t t_us)
+{
+    struct timespec ts = { t_us / 1000000, (t_us % 1000000) * 1000 };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) && !g_stop)
+        ;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-s <speed>] [-l <loops>] <file>\n"
+            "  -s  replay speed factor, 0 for as fast as possible (default 1)\n"
+            "  -l  number of times to replay the file (default 1)\n"
+            "The airline has to run with replayMode=1\n",
+            prog);
+}
+
+int main(int argc, char *argv[])
+{
+    DEFINE_MBUF(mbuf);
+    wfrec_hdr_t hdr;
+    wfrec_rec_t rec;
+    FILE *      fp;
+    double      speed = 1;
+    int         opt, loops = 1, loop;
+    uint64_t    t_beg, t_first, t_due, t_now, frames = 0, late = 0, late_max = 0;
+
+    while ((opt = getopt(argc, argv, "s:l:h")) != -1) {
+        switch (opt) {
+        case 's':
+            speed = atof(optarg);
+            break;
+        case 'l':
+            loops = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || speed < 0 || loops < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    fp = fopen(argv[optind], "r");
+    if (!fp) {
+        perror(argv[optind]);
+        return 1;
+    }
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != WFREC_MAGIC) {
+        fprintf(stderr, "%s: not a recording\n", argv[optind]);
+        return 1;
+    }
+    if (hdr.ver != WFREC_VER) {
+        fprintf(stderr, "%s: unsupported recording version %u\n", argv[optind], hdr.ver);
+        return 1;
+    }
+    printf("recorded with numOfNodes=%u\n", hdr.num_nodes);
+    signal(SIGINT, sig_handler);
+    signal(SIGTERM, sig_handler);
+    if (cl_init(MTYPE(STACKLINE, CL_MGR_ID), CL_ATTACHQ) != SUCCESS) {
+        fprintf(stderr, "commline init failed, is the airline running?\n");
+        return 1;
+    }
+    t_beg = now_us();
+    for (loop = 0; loop < loops && !g_stop; loop++) {
+        fseek(fp, sizeof(hdr), SEEK_SET);
+        t_first = 0;
+        t_due   = now_us();
+        while (!g_stop && fread(&rec, sizeof(rec), 1, fp) == 1) {
+            if (rec.len < sizeof(msg_buf_t) || rec.len > sizeof(msg_buf_t) + COMMLINE_MAX_BUF ||
+                fread(mbuf, rec.len, 1, fp) != 1) {
+                fprintf(stderr, "truncated record after %" PRIu64 " frames\n", frames);
+                break;
+            }
+            if (!t_first) {
+                t_first = rec.t_us;
+            }
+            if (speed > 0) {
+                uint64_t due = t_due + (uint64_t)((rec.t_us - t_first) / speed);
+
+                t_now = now_us();
+                if (due > t_now) {
+                    sleep_until(due);
+                } else if (t_now - due > late_max) {
+                    late_max = t_now - due;
+                }
+                late += t_now > due ? t_now - due : 0;
+            }
+            mbuf->max_len = COMMLINE_MAX_BUF;
+            if (cl_sendto_q(MTYPE(AIRLINE, CL_MGR_ID), mbuf, rec.len) != SUCCESS) {
+                fprintf(stderr, "send to airline failed\n");
+                g_stop = 1;
+                break;
+            }
+            frames++;
+        }
+    }
+    t_now = now_us() - t_beg;
+    printf("frames=%" PRIu64 " time_ms=%" PRIu64 " frames_per_sec=%.0f", frames, t_now / 1000,
+           t_now ? frames * 1e6 / t_now : 0);
+    if (speed > 0) {
+        printf(" late_avg_us=%.1f late_max_us=%" PRIu64, frames ? (double)late / frames : 0,
+               late_max);
+    }
+    printf("\n");
+    cl_cleanup();
+    fclose(fp);
+    return 0;
+}
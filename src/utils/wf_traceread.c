@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Analyzer for the airline packet trace (traceFile=)
+ *
+ * Usage: wf_traceread [-s <src>] [-d <dst>] [-l] <file>
+ * Reports the time frames spend in each stage of the airline with a log2
+ * histogram per stage. The commline and queue stages are counted once per
+ * frame, the phy and total stages once per receiver.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "utils/wftrace.h"
+
+#define HIST_BUCKETS 26 // [0,1us) ... [2^24us, inf)
+
+enum {
+    HOP_COMMLINE, // t_enq -> t_rx, waiting on the airline socket
+    HOP_QUEUE,    // t_rx -> t_mac, MAC queue and CSMA backoff
+    HOP_PHY,      // t_mac -> t_dlv, retries, air time and rx scheduling
+    HOP_AIRLINE,  // t_rx -> t_dlv
+    HOP_MAX,
+};
+
+static const char *g_hop_name[HOP_MAX] = {
+    "commline", "queue", "phy", "airline",
+};
+
+typedef struct _hop_ {
+    uint64_t *val;
+    size_t    cnt, sz;
+    uint64_t  sum;
+    uint64_t  hist[HIST_BUCKETS];
+} hop_t;
+
+static hop_t g_hop[HOP_MAX];
+
+static void hop_add(hop_t *h, uint64_t beg, uint64_t end)
+{
+    uint64_t d;
+    int      b;
+
+    if (!beg || !end || end < beg) {
+        return;
+    }
+    d = end - beg;
+    if (h->cnt == h->sz) {
+        h->sz  = h->sz ? h->sz * 2 : 4096;
+        h->val = realloc(h->val, h->sz * sizeof(*h->val));
+        if (!h->val) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    h->val[h->cnt++] = d;
+    h->sum += d;
+    for (b = 0; b < HIST_BUCKETS - 1 && d >= (1ULL << b); b++)
+        ;
+    h->hist[b]++;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void hop_report(const char *name, hop_t *h)
+{
+    uint64_t peak = 0;
+    int      b, lo, hi;
+
+    printf("%-8s ", name);
+    if (!h->cnt) {
+        printf("no samples\n");
+        return;
+    }
+    qsort(h->val, h->cnt, sizeof(*h->val), cmp_u64);
+    printf("n=%zu min=%" PRIu64 " avg=%.1f p50=%" PRIu64 " p90=%" PRIu64
+           " p99=%" PRIu64 " max=%" PRIu64 " (usec)\n",
+           h->cnt, h->val[0], (double)h->sum / h->cnt, h->val[h->cnt / 2],
+           h->val[h->cnt * 90 / 100], h->val[h->cnt * 99 / 100], h->val[h->cnt - 1]);
+    for (lo = 0; lo < HIST_BUCKETS && !h->hist[lo]; lo++)
+        ;
+    for (hi = HIST_BUCKETS - 1; hi > lo && !h->hist[hi]; hi--)
+        ;
+    for (b = lo; b <= hi; b++) {
+        peak = h->hist[b] > peak ? h->hist[b] : peak;
+    }
+    for (b = lo; b <= hi; b++) {
+        int bar = (int)(h->hist[b] * 50 / peak);
+
+        if (b == 0) {
+            printf("  %10s %9s ", "0", "1");
+        } else if (b == HIST_BUCKETS - 1) {
+            printf("  %10llu %9s ", 1ULL << (b - 1), "inf");
+        } else {
+            printf("  %10llu %9llu ", 1ULL << (b - 1), 1ULL << b);
+        }
+        printf("%10" PRIu64 " %.*s\n", h->hist[b], bar,
+               "##################################################");
+    }
+}
+
+/* Frame ids are sequential, a bitmap tells the first record of a frame */
+static int first_of_frame(uint64_t id)
+{
+    static uint8_t *seen;
+    static uint64_t seen_sz;
+    uint64_t        sz;
+
+    if (id >= seen_sz * 8) {
+        sz   = (id / 8 + 1) * 2;
+        seen = realloc(seen, sz);
+        if (!seen) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        memset(seen + seen_sz, 0, sz - seen_sz);
+        seen_sz = sz;
+    }
+    if (seen[id / 8] & (1 << (id % 8))) {
+        return 0;
+    }
+    seen[id / 8] |= 1 << (id % 8);
+    return 1;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-s <src>] [-d <dst>] [-l] <file>\n"
+            "  -s  only frames sent by this node\n"
+            "  -d  only frames received by this node\n"
+            "  -l  list the records instead of the histograms\n",
+            prog);
+}
+
+int main(int argc, char *argv[])
+{
+    wftrace_hdr_t hdr;
+    wftrace_rec_t rec;
+    FILE *        fp;
+    int64_t       src = -1, dst = -1;
+    int           opt, list = 0, i;
+    uint64_t      nrec = 0;
+
+    while ((opt = getopt(argc, argv, "s:d:lh")) != -1) {
+        switch (opt) {
+        case 's':
+            src = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            dst = strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            list = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    fp = fopen(argv[optind], "r");
+    if (!fp) {
+        perror(argv[optind]);
+        return 1;
+    }
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != WFTRACE_MAGIC) {
+        fprintf(stderr, "%s: not a trace file\n", argv[optind]);
+        return 1;
+    }
+    if (hdr.ver != WFTRACE_VER || hdr.rec_sz != sizeof(rec)) {
+        fprintf(stderr, "%s: unsupported trace version %u\n", argv[optind], hdr.ver);
+        return 1;
+    }
+    if (list) {
+        printf("id,src,dst,len,tries,t_enq_us,t_rx_us,t_mac_us,t_dlv_us\n");
+    }
+    while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+        if ((src >= 0 && rec.src != src) || (dst >= 0 && rec.dst != dst)) {
+            continue;
+        }
+        nrec++;
+        if (list) {
+            printf("%" PRIu64 ",%u,%u,%u,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                   rec.id, rec.src, rec.dst, rec.len, rec.tries,
+                   rec.t_enq_us, rec.t_rx_us, rec.t_mac_us, rec.t_dlv_us);
+            continue;
+        }
+        if (first_of_frame(rec.id)) {
+            hop_add(&g_hop[HOP_COMMLINE], rec.t_enq_us, rec.t_rx_us);
+            hop_add(&g_hop[HOP_QUEUE], rec.t_rx_us, rec.t_mac_us);
+        }
+        hop_add(&g_hop[HOP_PHY], rec.t_mac_us, rec.t_dlv_us);
+        hop_add(&g_hop[HOP_AIRLINE], rec.t_rx_us, rec.t_dlv_us);
+    }
+    fclose(fp);
+    if (list) {
+        return 0;
+    }
+    printf("records=%" PRIu64 "\n", nrec);
+    for (i = 0; i < HOP_MAX; i++) {
+        hop_report(g_hop_name[i], &g_hop[i]);
+    }
+    return 0;
+}
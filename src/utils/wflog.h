@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     stackline
+ * @{
+ *
+ * @file
+ * @brief       Aggregated node log file format
+ *
+ * The file is a sequence of chunks, each a wflog_chunk_t followed by clen
+ * bytes of zlib compressed records. A record is a wflog_rec_t followed by
+ * len bytes of a single log line without the newline. The chunk header
+ * carries the time and node id range of its records so that a reader can
+ * seek past chunks that do not match its filter without decompressing them.
+ * All fields are in host byte order.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _WFLOG_H_
+#define _WFLOG_H_
+
+#include <stdint.h>
+
+#define WFLOG_MAGIC    0x434c4657 // "WFLC"
+#define WFLOG_CHUNK_SZ (64 * 1024) // max uncompressed bytes per chunk
+#define WFLOG_LINE_MAX 1024        // longer lines are split
+#define WFLOG_FILE     "nodes.wflog"
+
+typedef struct __attribute__((packed)) _wflog_chunk_ {
+    uint32_t magic;
+    uint32_t clen; // compressed bytes following this header
+    uint32_t ulen; // uncompressed bytes
+    uint32_t nrec;
+    uint64_t t_first_us; // CLOCK_REALTIME
+    uint64_t t_last_us;
+    uint32_t node_min;
+    uint32_t node_max;
+} wflog_chunk_t;
+
+typedef struct __attribute__((packed)) _wflog_rec_ {
+    uint64_t t_us;
+    uint32_t nodeid;
+    uint16_t len;
+} wflog_rec_t;
+
+#endif // _WFLOG_H_
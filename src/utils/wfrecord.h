@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Airline commline recording file format
+ *
+ * The file is a wfrec_hdr_t followed by one wfrec_rec_t per frame the
+ * airline read from a stackline, each followed by rec.len bytes of the
+ * frame (msg_buf_t header and payload) as read. Timestamps are
+ * CLOCK_MONOTONIC in usec, only their differences are meaningful. All
+ * fields are in host byte order.
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _WFRECORD_H_
+#define _WFRECORD_H_
+
+#include <stdint.h>
+
+#define WFREC_MAGIC 0x43524657 // "WFRC"
+#define WFREC_VER   1
+
+typedef struct __attribute__((packed)) _wfrec_hdr_ {
+    uint32_t magic;
+    uint16_t ver;
+    uint16_t rsvd;
+    uint32_t num_nodes; // numOfNodes of the recorded run
+} wfrec_hdr_t;
+
+typedef struct __attribute__((packed)) _wfrec_rec_ {
+    uint64_t t_us;
+    uint16_t len;
+} wfrec_rec_t;
+
+#endif // _WFRECORD_H_
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * This file is subject to the terms and conditions of the GNU
+ * General Public License v2. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     airline
+ * @{
+ *
+ * @file
+ * @brief       Airline packet trace file format
+ *
+ * The file is a wftrace_hdr_t followed by one wftrace_rec_t per frame
+ * delivered to a stackline. A frame sent by one node and received by many
+ * has one record per receiver, all with the same id. Timestamps are
+ * CLOCK_REALTIME in usec. All fields are in host byte order.
+ *
+ * Inside the airline the record rides behind the payload of the frame
+ * (MBUF_HAS_TRACE) and is filled in as the frame passes each stage:
+ *   t_enq  stackline frame queued on the airline commline socket
+ *   t_rx   airline read the frame (msgrecvCallback)
+ *   t_mac  first MAC transmission attempt
+ *   t_dlv  frame sent to the receiving stackline
+ *
+ * @author      Rahul Jadhav <nyrahul@gmail.com>
+ *
+ * @}
+ */
+
+#ifndef _WFTRACE_H_
+#define _WFTRACE_H_
+
+#include <stdint.h>
+
+#define WFTRACE_MAGIC 0x52544657 // "WFTR"
+#define WFTRACE_VER   1
+
+typedef struct __attribute__((packed)) _wftrace_hdr_ {
+    uint32_t magic;
+    uint16_t ver;
+    uint16_t rec_sz; // sizeof(wftrace_rec_t)
+} wftrace_hdr_t;
+
+typedef struct __attribute__((packed)) _wftrace_rec_ {
+    uint64_t id; // unique per frame sent by a stackline
+    uint32_t src;
+    uint32_t dst; // receiving node
+    uint16_t len;
+    uint8_t  tries; // MAC transmission attempts so far
+    uint8_t  rsvd;
+    uint64_t t_enq_us; // 0 if not known
+    uint64_t t_rx_us;
+    uint64_t t_mac_us; // 0 if the PHY does not report it
+    uint64_t t_dlv_us;
+} wftrace_rec_t;
+
+#endif // _WFTRACE_H_